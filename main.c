@@ -1,23 +1,56 @@
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "micolisp.h"
 
-int main (int argslen, char **args){
-  FILE *input;
-  if (1 < argslen){
-    FILE *file = fopen(args[1], "r");
-    if (file == NULL){ return 1; }
-    input = file;
-  }
-  else {
-    input = stdin;
+// usage: micolisp.exe [--cache] [script]
+// with --cache, read forms of the script are cached in MICOLISP_CACHE_DIRECTORY, 
+// or in micolisp of XDG_CACHE_HOME or ~/.cache, which are private to the user.
+
+static char *cache_directory (){
+  char *directory = getenv("MICOLISP_CACHE_DIRECTORY");
+  if (directory != NULL && directory[0] != '\0'){ return strdup(directory); }
+  char *home = getenv("XDG_CACHE_HOME");
+  char *suffix = "/micolisp";
+  if (home == NULL || home[0] == '\0'){
+    home = getenv("HOME");
+    suffix = "/.cache/micolisp";
+    if (home == NULL || home[0] == '\0'){ return NULL; }
   }
+  size_t size = strlen(home) + strlen(suffix) + 1;
+  directory = malloc(size);
+  if (directory == NULL){ return NULL; }
+  snprintf(directory, size, "%s%s", home, suffix);
+  // the parent like ~/.cache may not exist yet.
+  char *slash = strrchr(directory, '/');
+  *slash = '\0';
+  mkdir(directory, 0700);
+  *slash = '/';
+  return directory;
+}
+
+int main (int argslen, char **args){
   micolisp_machine machine;
   if (micolisp_open(&machine) != 0){ return 1; }
-  if (micolisp_load_library(&machine) != 0){ return 1; }
-  if (micolisp_repl(input, stdout, stderr, &machine) != 0){ return 1; }
-  if (micolisp_close(&machine) != 0){ return 1; }
-  return 0;
+  char *directory = NULL;
+  int index = 1;
+  if (index < argslen && strcmp(args[index], "--cache") == 0){
+    directory = cache_directory();
+    machine.scriptcache = directory != NULL;
+    machine.cachedirectory = directory;
+    index += 1;
+  }
+  int status = micolisp_load_library(&machine);
+  if (status == 0 && index < argslen){
+    status = micolisp_run_script(args[index], stdout, stderr, &machine);
+  }
+  else 
+  if (status == 0){
+    status = micolisp_repl(stdin, stdout, stderr, &machine);
+  }
+  // the machine and the directory are released on every exit.
+  if (micolisp_close(&machine) != 0){ status = 1; }
+  free(directory);
+  return status != 0;
 }
@@ -4,6 +4,15 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "memnode.h"
 #include "hashset.h"
 #include "hashtable.h"
@@ -12,6 +21,7 @@
 
 #ifndef MAX 
 #define MAX(a, b) ((a)<(b)?(b):(a))
+#define MIN(a, b) ((a)<(b)?(a):(b))
 #endif 
 
 // hashset
@@ -42,15 +52,45 @@ static bool __hashtable_compare (void *symbol1, void *symbol2, void *arg){
 static const hashtable_class __MICOLISP_HASHTABLE_CLASS = { __hashtable_hash, __hashtable_compare, NULL, NULL };
 static const hashtable_class *MICOLISP_HASHTABLE_CLASS = &__MICOLISP_HASHTABLE_CLASS;
 
-// string utility 
+// address table 
 
-static bool string_find0 (char character, char *characters){
-  for (char *c = characters; *c != '\0'; c++){
-    if (*c == character){ return true; }
+static size_t __address_hash (void *address, void *arg){
+  return (size_t)(uintptr_t)address >> 3;
+}
+
+static bool __address_compare (void *address1, void *address2, void *arg){
+  return address1 == address2;
+}
+
+static const hashtable_class __MICOLISP_ADDRESS_CLASS = { __address_hash, __address_compare, NULL, NULL };
+static const hashtable_class *MICOLISP_ADDRESS_CLASS = &__MICOLISP_ADDRESS_CLASS;
+
+// entries are owned by the table, and free() them after use.
+
+static int address_table_set (void *value, void *key, hashtable *table){
+  if (hashtable_set(value, key, table) == 0){ return 0; }
+  size_t newlen = MAX(64, table->length * 2);
+  hashtable_entry *oldentries = table->entries;
+  hashtable_entry *newentries = malloc(newlen * sizeof(hashtable_entry));
+  if (newentries == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
   }
-  return false;
+  if (hashtable_stretch(newentries, newlen, table) != 0){
+    free(newentries);
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_stretch() was failed.");
+    return 1;
+  }
+  free(oldentries);
+  if (hashtable_set(value, key, table) != 0){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_set() was failed.");
+    return 1;
+  }
+  return 0;
 }
 
+// string utility 
+
 static size_t string_length (char *characters){
   char *c = characters;
   while (*c != '\0'){ c++; }
@@ -93,17 +133,6 @@ static size_t list_length (micolisp_cons *cons){
   return length;
 }
 
-static micolisp_cons *list_nreverse (micolisp_cons *list){
-  micolisp_cons *consprevious = NULL;
-  while (list != NULL){
-    micolisp_cons *consnext = list->cdr;
-    list->cdr = consprevious;
-    consprevious = list;
-    list = consnext;
-  }
-  return consprevious;
-}
-
 // error info 
 
 _Thread_local micolisp_error_info micolisp_error = { MICOLISP_NOERROR, {} };
@@ -143,58 +172,154 @@ void micolisp_error_get (int *codep, char *messagep){
 // number 
 
 micolisp_number *micolisp_allocate_number (micolisp_machine *machine){
-  return micolisp_allocate(MICOLISP_NUMBER, sizeof(micolisp_number), machine);
+  micolisp_number_cell *cell = micolisp_allocate(MICOLISP_NUMBER, sizeof(micolisp_number_cell), machine);
+  if (cell == NULL){ return NULL; }
+  cell->references = 1;
+  return &(cell->number);
 }
 
 // symbol 
 
+#define MICOLISP_STRING_NODE_SIZE 4096
+
+static size_t align_size (size_t, size_t);
+static micolisp_arena_node *make_micolisp_arena_node (size_t, micolisp_arena_node*);
+static bool micolisp_account_reservablep (micolisp_memory_type, size_t, micolisp_memory_account*);
+static void micolisp_account_reserve (micolisp_memory_type, size_t, micolisp_memory_account*);
+static int micolisp_memory_decrease (micolisp_memory_type, void*, size_t, micolisp_memory*);
+static void micolisp_account_free (micolisp_memory_type, size_t, size_t, micolisp_memory_account*);
+
+// FxHash over words, then finished with the murmur3 mixer,
+// so low bits are usable for the tables.
+
 static size_t calculate_hash (char *characters, size_t length){
-  size_t hash = 0;
-  for (size_t index = 0; index < length; index++){
-    size_t trueindex = index % sizeof(hash);
-    ((uint8_t*)&hash)[trueindex] ^= characters[index];
+  uint64_t hash = 0;
+  size_t index = 0;
+  for (; index + sizeof(uint64_t) <= length; index += sizeof(uint64_t)){
+    uint64_t word;
+    memcpy(&word, characters + index, sizeof(word));
+    hash = (((hash << 5) | (hash >> 59)) ^ word) * 0x517cc1b727220a95;
+  }
+  for (; index < length; index++){
+    hash = (((hash << 5) | (hash >> 59)) ^ (uint8_t)characters[index]) * 0x517cc1b727220a95;
+  }
+  hash ^= length;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+  return (size_t)hash;
+}
+
+// names are kept as length-prefixed strings in the string arena.
+
+// names of released symbols are linked by their prefix, and reused by the same size.
+
+static size_t micolisp_string_class (size_t length){
+  return align_size(sizeof(size_t) + length, sizeof(size_t)) / sizeof(size_t) -1;
+}
+
+static char *micolisp_string_intern (char *characters, size_t length, micolisp_machine *machine){
+  size_t size = align_size(sizeof(size_t) + length, sizeof(size_t));
+  size_t class = micolisp_string_class(length);
+  if (class < MICOLISP_STRING_CLASS_LENGTH && machine->freestrings[class] != NULL){
+    char *sequence = machine->freestrings[class];
+    machine->freestrings[class] = *(char**)sequence;
+    *(size_t*)sequence = length;
+    copy(characters, length, sequence + sizeof(size_t));
+    return sequence + sizeof(size_t);
+  }
+  micolisp_arena_node *node = machine->strings;
+  if (node == NULL || node->size < node->used + size){
+    size_t nodesize = MAX(MICOLISP_STRING_NODE_SIZE, size);
+    if (!micolisp_account_reservablep(MICOLISP_SYMBOL, nodesize, &(machine->account))){
+      micolisp_error_set0(MICOLISP_MEMORY_ERROR, "memory limit was exceeded.");
+      return NULL;
+    }
+    node = make_micolisp_arena_node(nodesize, node);
+    if (node == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+      return NULL;
+    }
+    machine->strings = node;
+    micolisp_account_reserve(MICOLISP_SYMBOL, nodesize, &(machine->account));
   }
-  return hash;
+  char *sequence = node->sequence + node->used;
+  *(size_t*)sequence = length;
+  copy(characters, length, sequence + sizeof(size_t));
+  node->used += size;
+  return sequence + sizeof(size_t);
 }
 
-static int micolisp_symbol_init (char *characters, size_t length, micolisp_symbol *symbol){
-  if (length <= MICOLISP_SYMBOL_MAX_LENGTH){
-    copy(characters, length, symbol->characters);
-    symbol->length = length;
-    symbol->hash = calculate_hash(characters, length);
-    return 0;
+static void micolisp_string_release (char *characters, size_t length, micolisp_machine *machine){
+  size_t class = micolisp_string_class(length);
+  if (class < MICOLISP_STRING_CLASS_LENGTH){
+    char *sequence = characters - sizeof(size_t);
+    *(char**)sequence = machine->freestrings[class];
+    machine->freestrings[class] = sequence;
   }
-  else {
-    micolisp_error_set0(MICOLISP_VALUE_ERROR, "symbol name's length must be less than MICOLISP_ERROR_INFO_MAX_LENGTH."); 
+}
+
+static void micolisp_symbol_init (char *characters, size_t length, micolisp_symbol *symbol){
+  symbol->characters = characters;
+  symbol->length = length;
+  symbol->hash = calculate_hash(characters, length);
+  symbol->references = 0;
+}
+
+// the symbol table is the only holder of its entries.
+
+static int micolisp_symbol_table_resize (size_t newlen, micolisp_machine *machine){
+  size_t oldlen = machine->symbol.length;
+  hashset_entry *oldentries = machine->symbol.entries;
+  hashset_entry *newentries = micolisp_allocate(MICOLISP_HASHSET_ENTRY, newlen * sizeof(hashset_entry), machine);
+  if (newentries == NULL){ return 1; }
+  if (hashset_stretch(newentries, newlen, &(machine->symbol)) != 0){ 
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashset_stretch() was failed."); 
     return 1; 
   }
+  if (oldentries != NULL){
+    if (micolisp_memory_decrease(MICOLISP_HASHSET_ENTRY, oldentries, oldlen * sizeof(hashset_entry), &(machine->memory)) != 0){ return 1; }
+  }
+  return 0;
 }
 
+// the table is weak, so it is shrunk here when released symbols leave it sparse.
+
 micolisp_symbol *micolisp_allocate_symbol (char *characters, size_t length, micolisp_machine *machine){
   micolisp_symbol symbol;
-  if (micolisp_symbol_init(characters, length, &symbol) != 0){ return NULL; }
+  micolisp_symbol_init(characters, length, &symbol);
   void *foundsymbol;
+  // symbols of the origin are shared, so names are kept identical in the clone.
+  for (micolisp_machine *origin = machine->origin; origin != NULL; origin = origin->origin){
+    if (hashset_get(&symbol, &(origin->symbol), &foundsymbol) == 0){ return foundsymbol; }
+  }
   if (hashset_get(&symbol, &(machine->symbol), &foundsymbol) != 0){
+    if (8 < machine->symbol.length && machine->symbollength * 4 < machine->symbol.length){
+      if (micolisp_symbol_table_resize(MAX(8, machine->symbol.length / 2), machine) != 0){ return NULL; }
+    }
+    // the name is interned first, so a failed allocation releases only the name.
+    symbol.characters = micolisp_string_intern(characters, length, machine);
+    if (symbol.characters == NULL){ return NULL; }
     micolisp_symbol *sym = micolisp_allocate(MICOLISP_SYMBOL, sizeof(micolisp_symbol), machine);
-    if (sym == NULL){ return NULL; }
+    if (sym == NULL){ 
+      micolisp_string_release(symbol.characters, length, machine);
+      return NULL; 
+    }
     *sym = symbol;
+    sym->references = 1;
     if (hashset_add(sym, &(machine->symbol)) != 0){
-      size_t newlen = MAX(8, machine->symbol.length * 2);
-      hashset_entry *newentries = micolisp_allocate(MICOLISP_HASHSET_ENTRY, newlen * sizeof(hashset_entry), machine);
-      if (newentries == NULL){ return NULL; }
-      if (hashset_stretch(newentries, newlen, &(machine->symbol)) != 0){ 
-        micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashset_stretch() was failed."); 
-        return NULL; 
-      }
-      if (hashset_add(sym, &(machine->symbol)) != 0){ 
+      if (micolisp_symbol_table_resize(MAX(8, machine->symbol.length * 2), machine) != 0 || hashset_add(sym, &(machine->symbol)) != 0){
+        micolisp_string_release(sym->characters, length, machine);
+        micolisp_memory_decrease(MICOLISP_SYMBOL, sym, sizeof(micolisp_symbol), &(machine->memory));
+        micolisp_account_free(MICOLISP_SYMBOL, 1, sizeof(micolisp_symbol), &(machine->account));
         micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashset_add() was failed."); 
         return NULL; 
       }
-      return sym;
-    }
-    else {
-      return sym;
     }
+    machine->symbollength += 1;
+    return sym;
   }
   else {
     if (micolisp_increase(foundsymbol, machine) != 0){ return NULL; }
@@ -202,6 +327,18 @@ micolisp_symbol *micolisp_allocate_symbol (char *characters, size_t length, mico
   }
 }
 
+// called when the last reference is released, before the memory is released.
+
+static int micolisp_symbol_forget (micolisp_symbol *symbol, micolisp_machine *machine){
+  if (hashset_delete(symbol, &(machine->symbol)) != 0){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashset_delete() was failed."); 
+    return 1;
+  }
+  machine->symbollength -= 1;
+  micolisp_string_release(symbol->characters, symbol->length, machine);
+  return 0;
+}
+
 micolisp_symbol *micolisp_allocate_symbol0 (char *characters, micolisp_machine *machine){
   size_t length = string_length(characters);
   return micolisp_allocate_symbol(characters, length, machine);
@@ -240,6 +377,7 @@ static int micolisp_c_function_call (micolisp_cons *args, micolisp_c_function *f
 static void micolisp_function_init (micolisp_function_type, micolisp_function*);
 static int micolisp_scope_begin (micolisp_machine*);
 static int micolisp_scope_end (micolisp_machine*);
+static int micolisp_arena_promote (void*, micolisp_machine*, void**);
 
 micolisp_user_function *micolisp_allocate_user_function (micolisp_function_type type, micolisp_cons *args, micolisp_cons *form, micolisp_machine *machine){
   void *argsdereferenced;
@@ -250,13 +388,15 @@ micolisp_user_function *micolisp_allocate_user_function (micolisp_function_type
     micolisp_error_set0(MICOLISP_TYPE_ERROR, "args must be a list.");
     return NULL; 
   }
-  if (micolisp_increase(argsdereferenced, machine) != 0){ return NULL; }
-  if (micolisp_increase(formdereferenced, machine) != 0){ return NULL; }
+  void *argspromoted;
+  void *formpromoted;
+  if (micolisp_arena_promote(argsdereferenced, machine, &argspromoted) != 0){ return NULL; }
+  if (micolisp_arena_promote(formdereferenced, machine, &formpromoted) != 0){ return NULL; }
   micolisp_user_function *function = micolisp_allocate(MICOLISP_USER_FUNCTION, sizeof(micolisp_user_function), machine);
   if (function == NULL){ return NULL; }
   micolisp_function_init(type, &(function->function));
-  function->args = argsdereferenced;
-  function->form = formdereferenced;
+  function->args = argspromoted;
+  function->form = formpromoted;
   return function;
 }
 
@@ -303,19 +443,27 @@ bool micolisp_functionp (void *function, micolisp_machine *machine){
   return micolisp_typep(MICOLISP_C_FUNCTION, function, machine) || micolisp_typep(MICOLISP_USER_FUNCTION, function, machine);
 }
 
+static void micolisp_list_builder_init (micolisp_list_builder*);
+static int micolisp_list_builder_push (void*, micolisp_list_builder*);
+static int micolisp_list_builder_abort (micolisp_list_builder*, micolisp_machine*);
+static int micolisp_list_builder_finish (void*, micolisp_list_builder*, micolisp_machine*, void**);
+
 static int eval_args (micolisp_cons *args, micolisp_machine *machine, micolisp_cons **argsevaluatedp){
-  micolisp_cons *argsevaluated = NULL;
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
   for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
     void *evaluated;
-    if (micolisp_eval(cons->car, machine, &evaluated) != 0){ return 1; }
-    micolisp_cons *cn = micolisp_allocate_cons(evaluated, argsevaluated, machine);
-    if (cn == NULL){ return 1; }
-    if (micolisp_decrease(evaluated, machine) != 0){ return 1; }
-    if (micolisp_decrease(argsevaluated, machine) != 0){ return 1; } 
-    argsevaluated = cn;
+    if (micolisp_eval(cons->car, machine, &evaluated) != 0){ 
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+    if (micolisp_list_builder_push(evaluated, &builder) != 0){ 
+      micolisp_decrease(evaluated, machine);
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
   }
-  *argsevaluatedp = list_nreverse(argsevaluated);
-  return 0;
+  return micolisp_list_builder_finish(NULL, &builder, machine, (void**)argsevaluatedp);
 }
 
 static int micolisp_function_call (micolisp_cons *args, void *function, micolisp_machine *machine, void **valuep){
@@ -341,6 +489,10 @@ static int micolisp_function_call (micolisp_cons *args, void *function, micolisp
       micolisp_error_set0(MICOLISP_TYPE_ERROR, "tried calling a non function."); 
       return 1; 
     }
+    if (status != 0){
+      micolisp_decrease(newargs, machine);
+      return status;
+    }
     void *newvalue;
     if (((micolisp_function*)function)->type == MICOLISP_MACRO){
       if (micolisp_eval(value, machine, &newvalue) != 0){ return 1; }
@@ -376,13 +528,24 @@ micolisp_cons *micolisp_quote (void *value, micolisp_machine *machine){
 
 // cons 
 
+static int micolisp_arena_hold (void*, micolisp_machine*);
+static int micolisp_arena_promote (void*, micolisp_machine*, void**);
+static micolisp_memory_type micolisp_memory_info (micolisp_memory_type, micolisp_memory*, size_t*, cgcmemnode**, cgcmemnode***);
+static void *micolisp_arena_allocate (micolisp_memory_type, size_t, micolisp_machine*);
+
 micolisp_cons *micolisp_allocate_cons (void *car, void *cdr, micolisp_machine *machine){
   void *cardereferenced;
   void *cdrdereferenced;
   if (micolisp_reference_get(car, machine, &cardereferenced) != 0){ return NULL; }
   if (micolisp_reference_get(cdr, machine, &cdrdereferenced) != 0){ return NULL; }
-  if (micolisp_increase(cardereferenced, machine) != 0){ return NULL; }
-  if (micolisp_increase(cdrdereferenced, machine) != 0){ return NULL; }
+  if (machine->arena.active){
+    if (micolisp_arena_hold(cardereferenced, machine) != 0){ return NULL; }
+    if (micolisp_arena_hold(cdrdereferenced, machine) != 0){ return NULL; }
+  }
+  else {
+    if (micolisp_arena_promote(cardereferenced, machine, &cardereferenced) != 0){ return NULL; }
+    if (micolisp_arena_promote(cdrdereferenced, machine, &cdrdereferenced) != 0){ return NULL; }
+  }
   micolisp_cons *cons = micolisp_allocate(MICOLISP_CONS, sizeof(micolisp_cons), machine);
   if (cons == NULL){ return NULL; }
   cons->car = cardereferenced;
@@ -390,19 +553,202 @@ micolisp_cons *micolisp_allocate_cons (void *car, void *cdr, micolisp_machine *m
   return cons;
 }
 
+// a fresh chain node is prepended, so the next count conses are allocated side by side.
+
+static int micolisp_cons_reserve (size_t count, micolisp_machine *machine){
+  size_t basesize;
+  cgcmemnode *cmemnode;
+  cgcmemnode **cmemnodep;
+  if (micolisp_memory_info(MICOLISP_CONS, &(machine->memory), &basesize, &cmemnode, &cmemnodep) != 0){ return 1; }
+  size_t newsize = align_size(count * sizeof(micolisp_cons), 4096);
+  if (count == 0 || !micolisp_account_reservablep(MICOLISP_CONS, newsize, &(machine->account))){ return 0; }
+  cgcmemnode *newcmemnode = make_cgcmemnode(newsize, basesize, cmemnode);
+  if (newcmemnode == NULL){ 
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function make_cgcmemnode() was failed.");
+    return 1; 
+  }
+  *cmemnodep = newcmemnode;
+  micolisp_account_reserve(MICOLISP_CONS, newsize, &(machine->account));
+  return 0;
+}
+
+// list builder takes over the counts of pushed values and the tail,
+// and allocates the conses in order, so a list is built in one pass and lies in one block.
+
+#define MICOLISP_LIST_BLOCK_LENGTH 256
+
+static void micolisp_list_builder_init (micolisp_list_builder *builder){
+  builder->values = builder->buffer;
+  builder->length = 0;
+  builder->capacity = MICOLISP_LIST_BUILDER_BUFFER_LENGTH;
+}
+
+static int micolisp_list_builder_push (void *value, micolisp_list_builder *builder){
+  if (builder->capacity <= builder->length){
+    size_t newcapacity = builder->capacity * 2;
+    void **newvalues = builder->values == builder->buffer? malloc(newcapacity * sizeof(void*)): realloc(builder->values, newcapacity * sizeof(void*));
+    if (newvalues == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    if (builder->values == builder->buffer){ copy((char*)builder->buffer, builder->length * sizeof(void*), (char*)newvalues); }
+    builder->values = newvalues;
+    builder->capacity = newcapacity;
+  }
+  builder->values[builder->length] = value;
+  builder->length += 1;
+  return 0;
+}
+
+static void micolisp_list_builder_free (micolisp_list_builder *builder){
+  if (builder->values != builder->buffer){ free(builder->values); }
+  micolisp_list_builder_init(builder);
+}
+
+// pushed values are released when the list could not be built.
+
+static int micolisp_list_builder_abort (micolisp_list_builder *builder, micolisp_machine *machine){
+  for (size_t index = 0; index < builder->length; index++){
+    if (micolisp_decrease(builder->values[index], machine) != 0){ return 1; }
+  }
+  micolisp_list_builder_free(builder);
+  return 0;
+}
+
+static int micolisp_list_builder_hold (void *value, micolisp_machine *machine, void **valuep){
+  void *valuedereferenced;
+  if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ return 1; }
+  if (machine->arena.active){
+    if (micolisp_arena_hold(valuedereferenced, machine) != 0){ return 1; }
+    *valuep = valuedereferenced;
+  }
+  else {
+    if (micolisp_arena_promote(valuedereferenced, machine, valuep) != 0){ return 1; }
+  }
+  return micolisp_decrease(value, machine);
+}
+
+// when the list could not be finished, the values not yet in the list and the tail are released,
+// so the caller has nothing left to abort.
+
+static int micolisp_list_builder_release (size_t start, void *tail, micolisp_list_builder *builder, micolisp_machine *machine){
+  for (size_t index = start; index < builder->length; index++){
+    micolisp_decrease(builder->values[index], machine);
+  }
+  micolisp_decrease(tail, machine);
+  micolisp_list_builder_free(builder);
+  return 1;
+}
+
+static int micolisp_list_builder_finish (void *tail, micolisp_list_builder *builder, micolisp_machine *machine, void **listp){
+  if (micolisp_list_builder_hold(tail, machine, &tail) != 0){ return micolisp_list_builder_release(0, tail, builder, machine); }
+  for (size_t index = 0; index < builder->length; index++){
+    if (micolisp_list_builder_hold(builder->values[index], machine, &(builder->values[index])) != 0){ 
+      return micolisp_list_builder_release(0, tail, builder, machine); 
+    }
+  }
+  if (!machine->arena.active && MICOLISP_LIST_BLOCK_LENGTH <= builder->length){
+    if (micolisp_cons_reserve(builder->length, machine) != 0){ return micolisp_list_builder_release(0, tail, builder, machine); }
+  }
+  micolisp_cons *list = NULL;
+  micolisp_cons *last = NULL;
+  for (size_t index = 0; index < builder->length; index++){
+    micolisp_cons *cons = micolisp_allocate(MICOLISP_CONS, sizeof(micolisp_cons), machine);
+    if (cons == NULL){ 
+      // the conses made so far hold the values before the index.
+      micolisp_decrease(list, machine);
+      return micolisp_list_builder_release(index, tail, builder, machine); 
+    }
+    cons->car = builder->values[index];
+    cons->cdr = NULL;
+    if (last == NULL){ list = cons; }
+    else { last->cdr = cons; }
+    last = cons;
+  }
+  if (last != NULL){ last->cdr = tail; }
+  micolisp_list_builder_free(builder);
+  *listp = list == NULL? tail: list;
+  return 0;
+}
+
+// the spine of a list is copied into one reserved block, so successive cdrs lie next to each other.
+// the old spine is left to its other holders, and the caller binds the copy in place of it.
+
+int micolisp_linearize (void *list, micolisp_machine *machine, void **listp){
+  void *listdereferenced;
+  if (micolisp_reference_get(list, machine, &listdereferenced) != 0){ return 1; }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  void *current = listdereferenced;
+  void *fast = listdereferenced;
+  while (micolisp_typep(MICOLISP_CONS, current, machine)){
+    // the fast cursor goes two conses a step, and meets the current one on a circular list.
+    for (size_t count = 0; count < 2 && micolisp_typep(MICOLISP_CONS, fast, machine); count++){ fast = ((micolisp_cons*)fast)->cdr; }
+    if (fast == current){
+      micolisp_list_builder_abort(&builder, machine);
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not linearize a circular list.");
+      return 1;
+    }
+    if (micolisp_increase(((micolisp_cons*)current)->car, machine) != 0){ 
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+    if (micolisp_list_builder_push(((micolisp_cons*)current)->car, &builder) != 0){ 
+      micolisp_decrease(((micolisp_cons*)current)->car, machine);
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+    current = ((micolisp_cons*)current)->cdr;
+  }
+  if (micolisp_increase(current, machine) != 0){ 
+    micolisp_list_builder_abort(&builder, machine);
+    return 1; 
+  }
+  // the builder reserves the block of a long list by itself.
+  if (!machine->arena.active && builder.length < MICOLISP_LIST_BLOCK_LENGTH){
+    if (micolisp_cons_reserve(builder.length, machine) != 0){ return micolisp_list_builder_release(0, current, &builder, machine); }
+  }
+  return micolisp_list_builder_finish(current, &builder, machine, listp);
+}
+
 int micolisp_cons_set (void *value, micolisp_cons_whence whence, micolisp_cons *cons, micolisp_machine *machine){
   void *valuedereferenced;
   if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ return 1; }
+  if (micolisp_sharedp(cons, machine)){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not modify a cons shared with the origin machine.");
+    return 1;
+  }
+  if (micolisp_segmentp(cons, machine)){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not modify a cons in a segment.");
+    return 1;
+  }
+  if (micolisp_arenap(cons, machine)){
+    // previous value is held by the arena until it is released.
+    switch (whence){
+      case MICOLISP_CONS_CAR:
+        if (micolisp_arena_hold(valuedereferenced, machine) != 0){ return 1; }
+        cons->car = valuedereferenced;
+        return 0;
+      case MICOLISP_CONS_CDR:
+        if (micolisp_arena_hold(valuedereferenced, machine) != 0){ return 1; }
+        cons->cdr = valuedereferenced;
+        return 0;
+      default:
+        micolisp_error_set0(MICOLISP_VALUE_ERROR, "given an unknown whence."); 
+        return 1;
+    }
+  }
+  void *valuepromoted;
   switch (whence){
     case MICOLISP_CONS_CAR:
-      if (micolisp_increase(valuedereferenced, machine) != 0){ return 1; }
+      if (micolisp_arena_promote(valuedereferenced, machine, &valuepromoted) != 0){ return 1; }
       if (micolisp_decrease(cons->car, machine) != 0){ return 1; }
-      cons->car = value;
+      cons->car = valuepromoted;
       return 0;
     case MICOLISP_CONS_CDR:
-      if (micolisp_increase(valuedereferenced, machine) != 0){ return 1; }
+      if (micolisp_arena_promote(valuedereferenced, machine, &valuepromoted) != 0){ return 1; }
       if (micolisp_decrease(cons->cdr, machine) != 0){ return 1; }
-      cons->cdr = value;
+      cons->cdr = valuepromoted;
       return 0;
     default:
       micolisp_error_set0(MICOLISP_VALUE_ERROR, "given an unknown whence."); 
@@ -425,8 +771,15 @@ int micolisp_cons_get (micolisp_cons_whence whence, micolisp_cons *cons, void **
 }
 
 micolisp_cons_reference *micolisp_cons_get_reference (micolisp_cons_whence whence, micolisp_cons *cons, micolisp_machine *machine){
-  if (micolisp_increase(cons, machine) != 0){ return NULL; }
-  micolisp_cons_reference *reference = micolisp_allocate(MICOLISP_CONS_REFERENCE, sizeof(micolisp_cons_reference), machine);
+  micolisp_cons_reference *reference;
+  if (machine->arena.active || micolisp_arenap(cons, machine)){
+    if (micolisp_arena_hold(cons, machine) != 0){ return NULL; }
+    reference = micolisp_arena_allocate(MICOLISP_CONS_REFERENCE, sizeof(micolisp_cons_reference), machine);
+  }
+  else {
+    if (micolisp_increase(cons, machine) != 0){ return NULL; }
+    reference = micolisp_allocate(MICOLISP_CONS_REFERENCE, sizeof(micolisp_cons_reference), machine);
+  }
   if (reference == NULL){ return NULL; }
   reference->whence = whence;
   reference->cons = cons;
@@ -443,6 +796,54 @@ int micolisp_cons_reference_get (micolisp_cons_reference *reference, void **valu
 
 // scope 
 
+static int micolisp_scope_stretch (micolisp_scope*, micolisp_machine*);
+static micolisp_scope *micolisp_scope_root (micolisp_machine*);
+
+// entries are pooled by power of two lengths from 8,
+// and linked through their first bytes while they are pooled.
+
+static size_t micolisp_entries_class (size_t length){
+  size_t class = 0;
+  while (class < MICOLISP_ENTRIES_CLASS_LENGTH && ((size_t)8 << class) < length){ class += 1; }
+  if (class < MICOLISP_ENTRIES_CLASS_LENGTH && ((size_t)8 << class) == length){ return class; }
+  return MICOLISP_ENTRIES_CLASS_LENGTH;
+}
+
+static hashtable_entry *micolisp_entries_allocate (size_t length, micolisp_machine *machine){
+  size_t class = micolisp_entries_class(length);
+  if (class < MICOLISP_ENTRIES_CLASS_LENGTH && machine->pool.entries[class] != NULL){
+    hashtable_entry *entries = machine->pool.entries[class];
+    machine->pool.entries[class] = *(hashtable_entry**)entries;
+    return entries;
+  }
+  return micolisp_allocate(MICOLISP_HASHTABLE_ENTRY, length * sizeof(hashtable_entry), machine);
+}
+
+static int micolisp_entries_release (hashtable_entry *entries, size_t length, micolisp_machine *machine){
+  if (entries == NULL){ return 0; }
+  size_t class = micolisp_entries_class(length);
+  if (class < MICOLISP_ENTRIES_CLASS_LENGTH){
+    *(hashtable_entry**)entries = machine->pool.entries[class];
+    machine->pool.entries[class] = entries;
+    return 0;
+  }
+  return micolisp_memory_decrease(MICOLISP_HASHTABLE_ENTRY, entries, length * sizeof(hashtable_entry), &(machine->memory));
+}
+
+// name is bound newly in the scope, and the value is already counted.
+
+static int micolisp_scope_bind (void *value, micolisp_symbol *name, micolisp_scope *scope, micolisp_machine *machine){
+  if (micolisp_increase(name, machine) != 0){ return 1; }
+  if (hashtable_set(value, name, &(scope->hashtable)) != 0){
+    if (micolisp_scope_stretch(scope, machine) != 0){ return 1; }
+    if (hashtable_set(value, name, &(scope->hashtable)) != 0){ 
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_set() was failed.");
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int micolisp_scope_set (void *value, micolisp_symbol *name, micolisp_machine *machine){
   void *valuedereferenced;
   void *namedereferenced;
@@ -453,7 +854,7 @@ int micolisp_scope_set (void *value, micolisp_symbol *name, micolisp_machine *ma
     return 1; 
   }
   if (machine->scope != NULL){
-    if (micolisp_increase(valuedereferenced, machine) != 0){ return 1; }
+    if (micolisp_arena_promote(valuedereferenced, machine, &valuedereferenced) != 0){ return 1; }
     void *foundvalue;
     if (hashtable_get(namedereferenced, &(machine->scope->hashtable), &foundvalue) == 0){
       if (micolisp_decrease(foundvalue, machine) != 0){ return 1; }
@@ -466,13 +867,7 @@ int micolisp_scope_set (void *value, micolisp_symbol *name, micolisp_machine *ma
     else {
       if (micolisp_increase(namedereferenced, machine) != 0){ return 1; }
       if (hashtable_set(valuedereferenced, namedereferenced, &(machine->scope->hashtable)) != 0){
-        size_t newlen = MAX(8, machine->scope->hashtable.length * 2);
-        hashtable_entry *newentries = micolisp_allocate(MICOLISP_HASHTABLE_ENTRY, newlen * sizeof(hashtable_entry), machine);
-        if (newentries == NULL){ return 1; }
-        if (hashtable_stretch(newentries, newlen, &(machine->scope->hashtable)) != 0){ 
-          micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_stretch() was failed.");
-          return 1; 
-        }
+        if (micolisp_scope_stretch(machine->scope, machine) != 0){ return 1; }
         if (hashtable_set(valuedereferenced, namedereferenced, &(machine->scope->hashtable)) != 0){
           micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_set() was failed.");
           return 1; 
@@ -513,6 +908,7 @@ micolisp_scope_reference *micolisp_scope_get_reference (micolisp_symbol *name, m
   }
   if (micolisp_increase(namedereferenced, machine) != 0){ return NULL; }
   if (micolisp_increase(machine->scope, machine) != 0){ return NULL; }
+  machine->scope->escaped = true;
   micolisp_scope_reference *reference = micolisp_allocate(MICOLISP_SCOPE_REFERENCE, sizeof(micolisp_scope_reference), machine);
   if (reference == NULL){ return NULL; }
   reference->name = namedereferenced;
@@ -523,10 +919,14 @@ micolisp_scope_reference *micolisp_scope_get_reference (micolisp_symbol *name, m
 int micolisp_scope_reference_set (void *value, micolisp_scope_reference *reference, micolisp_machine *machine){
   void *valuedereferenced;
   if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ return 1; }
-  if (micolisp_increase(valuedereferenced, machine) != 0){ return 1; }
+  if (micolisp_arena_promote(valuedereferenced, machine, &valuedereferenced) != 0){ return 1; }
   for (micolisp_scope *scope = reference->scope; scope != NULL; scope = scope->parent){
     void *foundvalue;
     if (hashtable_get(reference->name, &(scope->hashtable), &foundvalue) == 0){
+      if (micolisp_sharedp(scope, machine)){
+        // a binding of the origin is copied into the root of the clone.
+        return micolisp_scope_bind(valuedereferenced, reference->name, micolisp_scope_root(machine), machine);
+      }
       if (micolisp_decrease(foundvalue, machine) != 0){ return 1; }
       if (hashtable_set(valuedereferenced, reference->name, &(scope->hashtable)) != 0){ 
         micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_set() was failed.");
@@ -535,24 +935,7 @@ int micolisp_scope_reference_set (void *value, micolisp_scope_reference *referen
       return 0;
     }
   }
-  if (micolisp_increase(reference->name, machine) != 0){ return 1; }
-  if (hashtable_set(valuedereferenced, reference->name, &(reference->scope->hashtable)) != 0){
-    size_t newlen = machine->scope->hashtable.length * 2;
-    hashtable_entry *newentries = micolisp_allocate(MICOLISP_HASHTABLE_ENTRY, newlen * sizeof(MICOLISP_HASHTABLE_ENTRY), machine);
-    if (newentries == NULL){ return 1; }
-    if (hashtable_stretch(newentries, newlen, &(reference->scope->hashtable)) != 0){ 
-      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_stretch() was failed.");
-      return 1;
-    }
-    if (hashtable_set(valuedereferenced, reference->name, &(reference->scope->hashtable)) != 0){ 
-      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_set() was failed.");
-      return 1;
-    }
-    return 0;
-  }
-  else {
-    return 0;
-  }
+  return micolisp_scope_bind(valuedereferenced, reference->name, reference->scope, machine);
 }
 
 int micolisp_scope_reference_get (micolisp_scope_reference *reference, void **valuep){
@@ -564,22 +947,48 @@ int micolisp_scope_reference_get (micolisp_scope_reference *reference, void **va
 }
 
 static int micolisp_scope_begin (micolisp_machine *machine){
-  if (micolisp_increase(machine->scope, machine) != 0){ return 1; }
-  micolisp_scope *scope = micolisp_allocate(MICOLISP_SCOPE, sizeof(micolisp_scope), machine);
-  if (scope == NULL){ return 1; }
-  hashtable_entry *scopeentries = micolisp_allocate(MICOLISP_HASHTABLE_ENTRY, 8 * sizeof(hashtable_entry), machine);
-  if (scopeentries == NULL){ return 1; }
-  hashtable_init(scopeentries, 8, MICOLISP_HASHTABLE_CLASS, &(scope->hashtable));
+  micolisp_scope *scope = machine->pool.scopes;
+  if (scope != NULL){
+    machine->pool.scopes = scope->parent;
+    hashtable_init(scope->hashtable.entries, scope->hashtable.length, MICOLISP_HASHTABLE_CLASS, &(scope->hashtable));
+  }
+  else {
+    scope = micolisp_allocate(MICOLISP_SCOPE, sizeof(micolisp_scope), machine);
+    if (scope == NULL){ return 1; }
+    hashtable_entry *scopeentries = micolisp_entries_allocate(8, machine);
+    if (scopeentries == NULL){ return 1; }
+    hashtable_init(scopeentries, 8, MICOLISP_HASHTABLE_CLASS, &(scope->hashtable));
+  }
   scope->parent = machine->scope;
+  scope->escaped = false;
   machine->scope = scope;
   return 0;
 }
 
+// a scope which is not escaped is held only by the machine,
+// so its bindings are released and the frame is recycled.
+// an escaped scope keeps its parent alive, because references walk the parents.
+
 static int micolisp_scope_end (micolisp_machine *machine){
   if (machine->scope != NULL){
-    micolisp_scope *parent = machine->scope->parent;
-    if (micolisp_decrease(machine->scope, machine) != 0){ return 1; }
+    micolisp_scope *scope = machine->scope;
+    micolisp_scope *parent = scope->parent;
     machine->scope = parent;
+    if (scope->escaped){
+      if (parent != NULL){
+        parent->escaped = true;
+        if (micolisp_increase(parent, machine) != 0){ return 1; }
+      }
+      return micolisp_decrease(scope, machine);
+    }
+    hashtable_iterator iterator = hashtable_iterate(&(scope->hashtable));
+    hashtable_entry entry;
+    while (hashtable_iterator_next(&iterator, &(scope->hashtable), &entry) == 0){
+      if (micolisp_decrease(entry.key, machine) != 0){ return 1; }
+      if (micolisp_decrease(entry.value, machine) != 0){ return 1; }
+    }
+    scope->parent = machine->pool.scopes;
+    machine->pool.scopes = scope;
     return 0;
   }
   else {
@@ -588,6 +997,31 @@ static int micolisp_scope_end (micolisp_machine *machine){
   }
 }
 
+// superseded entries are reclaimed only when the scope is held by the machine alone,
+// because increase and decrease of the scope count its entries together.
+
+static int micolisp_scope_stretch (micolisp_scope *scope, micolisp_machine *machine){
+  size_t newlen = MAX(8, scope->hashtable.length * 2);
+  size_t oldlen = scope->hashtable.length;
+  hashtable_entry *oldentries = scope->hashtable.entries;
+  hashtable_entry *newentries = micolisp_entries_allocate(newlen, machine);
+  if (newentries == NULL){ return 1; }
+  if (hashtable_stretch(newentries, newlen, &(scope->hashtable)) != 0){ 
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashtable_stretch() was failed.");
+    return 1; 
+  }
+  if (scope->escaped){ return 0; }
+  return micolisp_entries_release(oldentries, oldlen, machine);
+}
+
+// the root of a clone is its own outermost scope, whose parent is a scope of the origin.
+
+static micolisp_scope *micolisp_scope_root (micolisp_machine *machine){
+  micolisp_scope *scope = machine->scope;
+  while (scope != NULL && scope->parent != NULL && !micolisp_sharedp(scope->parent, machine)){ scope = scope->parent; }
+  return scope;
+}
+
 // reference 
 
 bool micolisp_referencep (void *address, micolisp_machine *machine){
@@ -635,6 +1069,8 @@ static void micolisp_memory_init (micolisp_memory *memory){
   memory->scopereference = NULL;
   memory->hashtableentry = NULL;
   memory->hashsetentry = NULL;
+  memory->low = NULL;
+  memory->high = NULL;
 } 
 
 static void micolisp_memory_free (micolisp_memory *memory){
@@ -655,7 +1091,7 @@ static micolisp_memory_type micolisp_memory_info (micolisp_memory_type type, mic
     case MICOLISP_NUMBER:
       *cmemnodep = memory->number;
       *cmemnodepp = &(memory->number);
-      *sizep = sizeof(micolisp_number);
+      *sizep = sizeof(micolisp_number_cell);
       return 0;
     case MICOLISP_SYMBOL:
       *cmemnodep = memory->symbol;
@@ -726,6 +1162,8 @@ static void *micolisp_memory_allocate (micolisp_memory_type type, size_t size, m
     micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function cgcmemnode_allocate() was failed.");
     return NULL;
   }
+  if (memory->low == NULL || (char*)address < memory->low){ memory->low = address; }
+  if (memory->high < (char*)address + size){ memory->high = (char*)address + size; }
   return address;
 }
 
@@ -753,23 +1191,151 @@ static int micolisp_memory_decrease (micolisp_memory_type type, void *address, s
   return 0;
 }
 
+// account 
+
+static void micolisp_account_init (micolisp_memory_account *account){
+  for (size_t index = 0; index < MICOLISP_MEMORY_TYPE_LENGTH; index++){
+    account->counts[index] = (micolisp_memory_count){ 0, 0, 0, 0, 0, 0 };
+    account->limits[index] = 0;
+  }
+  account->total = (micolisp_memory_count){ 0, 0, 0, 0, 0, 0 };
+  account->limit = 0;
+}
+
+static bool micolisp_account_reservablep (micolisp_memory_type type, size_t size, micolisp_memory_account *account){
+  size_t limit = account->limits[type];
+  if (0 < limit && limit < account->counts[type].reserved + size){ return false; }
+  if (0 < account->limit && account->limit < account->total.reserved + size){ return false; }
+  return true;
+}
+
+static void micolisp_account_reserve (micolisp_memory_type type, size_t size, micolisp_memory_account *account){
+  micolisp_memory_count *count = &(account->counts[type]);
+  count->reserved += size;
+  count->peak = MAX(count->peak, count->reserved);
+  account->total.reserved += size;
+  account->total.peak = MAX(account->total.peak, account->total.reserved);
+}
+
+static void micolisp_account_release (micolisp_memory_type type, size_t size, micolisp_memory_account *account){
+  account->counts[type].reserved -= size;
+  account->total.reserved -= size;
+}
+
+static void micolisp_account_allocate (micolisp_memory_type type, size_t size, bool live, micolisp_memory_account *account){
+  account->counts[type].allocated += 1;
+  account->counts[type].allocatedbytes += size;
+  account->total.allocated += 1;
+  account->total.allocatedbytes += size;
+  if (live){
+    account->counts[type].live += 1;
+    account->counts[type].livebytes += size;
+    account->total.live += 1;
+    account->total.livebytes += size;
+  }
+}
+
+static void micolisp_account_free (micolisp_memory_type type, size_t objects, size_t bytes, micolisp_memory_account *account){
+  account->counts[type].live -= objects;
+  account->counts[type].livebytes -= bytes;
+  account->total.live -= objects;
+  account->total.livebytes -= bytes;
+}
+
+// objects moved from another machine are counted as allocated and live in this one.
+
+static void micolisp_account_adopt (micolisp_memory_type type, size_t objects, size_t bytes, micolisp_memory_account *account){
+  account->counts[type].allocated += objects;
+  account->counts[type].allocatedbytes += bytes;
+  account->counts[type].live += objects;
+  account->counts[type].livebytes += bytes;
+  account->total.allocated += objects;
+  account->total.allocatedbytes += bytes;
+  account->total.live += objects;
+  account->total.livebytes += bytes;
+}
+
+static bool micolisp_account_livep (micolisp_memory_type type){
+  return type == MICOLISP_NUMBER || type == MICOLISP_SYMBOL;
+}
+
 // machine
 
+static void micolisp_arena_init (micolisp_arena*);
+static void micolisp_segment_free_all (micolisp_segment*);
+
 void micolisp_init (micolisp_machine *machine){
   micolisp_memory_init(&(machine->memory));
   machine->scope = NULL;
   hashset_init(NULL, 0, MICOLISP_HASHSET_CLASS, &(machine->symbol));
+  machine->freestack.entries = NULL;
+  machine->freestack.length = 0;
+  machine->freestack.capacity = 0;
+  machine->freestack.slots = NULL;
+  machine->freestack.slotslength = 0;
+  machine->freestack.slotscount = 0;
+  machine->freestack.oldslots = NULL;
+  machine->freestack.oldslotslength = 0;
+  machine->freestack.oldslotsindex = 0;
+  machine->freebudget = 0;
+  micolisp_arena_init(&(machine->arena));
+  machine->arenamode = MICOLISP_ARENA_NONE;
+  machine->regionsize = 0;
+  machine->numberreuse = true;
+  machine->resultargs = NULL;
+  machine->resultnumber = NULL;
+  machine->printprecision = 0;
+  machine->scriptcache = false;
+  machine->cachedirectory = NULL;
+  machine->origin = NULL;
+  machine->clones = 0;
+  machine->segments = NULL;
+  machine->hugepage = false;
+  micolisp_account_init(&(machine->account));
+  machine->strings = NULL;
+  machine->symbollength = 0;
+  for (size_t class = 0; class < MICOLISP_STRING_CLASS_LENGTH; class++){ machine->freestrings[class] = NULL; }
+  machine->pausetarget = 0;
+  machine->pause = (micolisp_pause){ 0, 0, 0, 0 };
+  machine->pool.scopes = NULL;
+  for (size_t class = 0; class < MICOLISP_ENTRIES_CLASS_LENGTH; class++){ machine->pool.entries[class] = NULL; }
 } 
 
+static bool micolisp_arena_typep (micolisp_memory_type, void*, micolisp_arena*);
+static bool micolisp_segment_typep (micolisp_memory_type, void*, micolisp_segment*);
+
 bool micolisp_typep (micolisp_memory_type type, void *address, micolisp_machine *machine){
-  return micolisp_memory_typep(type, address, &(machine->memory));
+  return 
+    micolisp_memory_typep(type, address, &(machine->memory)) || 
+    micolisp_arena_typep(type, address, &(machine->arena)) || 
+    micolisp_segment_typep(type, address, machine->segments) || 
+    (machine->origin != NULL && micolisp_typep(type, address, machine->origin));
+}
+
+// objects of the origin are shared with its clones, and the clones do not count them.
+// the bounds of the heap of the origin rule out most objects of the clone before the types are looked up,
+// and the bounds stay valid because the origin is not evaluated while its clones are open.
+
+bool micolisp_sharedp (void *address, micolisp_machine *machine){
+  for (micolisp_machine *origin = machine->origin; origin != NULL; origin = origin->origin){
+    if (origin->memory.low <= (char*)address && (char*)address < origin->memory.high){
+      for (micolisp_memory_type type = 0; type < MICOLISP_MEMORY_TYPE_LENGTH; type++){
+        if (micolisp_memory_typep(type, address, &(origin->memory))){ return true; }
+      }
+    }
+    if (micolisp_arenap(address, origin) || micolisp_segmentp(address, origin)){ return true; }
+  }
+  return false;
 }
 
 static size_t align_size (size_t size, size_t alignment){
   return (size / alignment * alignment) + (0 < size % alignment? alignment: 0);
 }
 
-void *micolisp_allocate (micolisp_memory_type type, size_t size, micolisp_machine *machine){
+static void *micolisp_allocate_heap (micolisp_memory_type type, size_t size, micolisp_machine *machine){
+  if ((0 < machine->freebudget || 0 < machine->pausetarget) && 0 < machine->freestack.length){
+    if (micolisp_collect_step(machine->freebudget, machine) != 0){ return NULL; }
+  }
   void *address = micolisp_memory_allocate(type, size, &(machine->memory));
   if (address == NULL){
     size_t basesize;
@@ -777,23 +1343,57 @@ void *micolisp_allocate (micolisp_memory_type type, size_t size, micolisp_machin
     cgcmemnode **cmemnodep;
     if (micolisp_memory_info(type, &(machine->memory), &basesize, &cmemnode, &cmemnodep) != 0){ return NULL; }
     size_t newsize = align_size(size, 4096);
+    if (!micolisp_account_reservablep(type, newsize, &(machine->account))){
+      // reclaim pending objects before giving up.
+      if (micolisp_collect(machine) != 0){ return NULL; }
+      address = micolisp_memory_allocate(type, size, &(machine->memory));
+      if (address == NULL){
+        micolisp_error_set0(MICOLISP_MEMORY_ERROR, "memory limit was exceeded.");
+        return NULL;
+      }
+      micolisp_account_allocate(type, size, micolisp_account_livep(type), &(machine->account));
+      return address;
+    }
     cgcmemnode *newcmemnode = make_cgcmemnode(newsize, basesize, cmemnode);
     if (newcmemnode == NULL){ 
       micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function make_cgcmemnode() was failed.");
       return NULL; 
     }
     *cmemnodep = newcmemnode;
+    micolisp_account_reserve(type, newsize, &(machine->account));
     void *address = micolisp_memory_allocate(type, size, &(machine->memory)); 
     if (address == NULL){ return NULL; }
+    micolisp_account_allocate(type, size, micolisp_account_livep(type), &(machine->account));
     return address;
   }
+  micolisp_account_allocate(type, size, micolisp_account_livep(type), &(machine->account));
   return address;
 }
 
+void *micolisp_allocate (micolisp_memory_type type, size_t size, micolisp_machine *machine){
+  if (machine->arena.active){
+    switch (type){
+      case MICOLISP_NUMBER:
+      case MICOLISP_CONS:
+      case MICOLISP_CONS_REFERENCE:
+        return micolisp_arena_allocate(type, size, machine);
+      default:
+        break;
+    }
+  }
+  return micolisp_allocate_heap(type, size, machine);
+}
+
 static int __micolisp_increase (void *address, micolisp_machine *machine, cgcmemnode_history *history){
   if (cgcmemnode_history_recordp(address, history)){
     return 0; 
   }
+  if (micolisp_arenap(address, machine)){
+    return 0;
+  }
+  if (micolisp_sharedp(address, machine) || micolisp_segmentp(address, machine)){
+    return 0;
+  }
   if (address == MICOLISP_NIL){
     return 0;
   }
@@ -803,12 +1403,14 @@ static int __micolisp_increase (void *address, micolisp_machine *machine, cgcmem
   }
   else 
   if (micolisp_typep(MICOLISP_NUMBER, address, machine)){
-    if (micolisp_memory_increase(MICOLISP_NUMBER, address, sizeof(micolisp_number), &(machine->memory)) != 0){ return 1; }
+    if (micolisp_memory_increase(MICOLISP_NUMBER, address, sizeof(micolisp_number_cell), &(machine->memory)) != 0){ return 1; }
+    ((micolisp_number_cell*)address)->references += 1;
     return 0;
   }
   else 
   if (micolisp_typep(MICOLISP_SYMBOL, address, machine)){
     if (micolisp_memory_increase(MICOLISP_SYMBOL, address, sizeof(micolisp_symbol), &(machine->memory)) != 0){ return 1; }
+    ((micolisp_symbol*)address)->references += 1;
     return 0;
   }
   else 
@@ -866,40 +1468,209 @@ static int __micolisp_increase (void *address, micolisp_machine *machine, cgcmem
   }
 }
 
-static int __micolisp_decrease (void *address, micolisp_machine *machine, cgcmemnode_history *history){
-  if (cgcmemnode_history_recordp(address, history)){
-    return 0; 
-  }
-  if (address == MICOLISP_NIL){
-    return 0;
+static int micolisp_free_stack_push (void *address, size_t parent, micolisp_free_stack *stack){
+  if (stack->capacity <= stack->length){
+    size_t newcapacity = MAX(64, stack->capacity * 2);
+    micolisp_free_entry *newentries = realloc(stack->entries, newcapacity * sizeof(micolisp_free_entry));
+    if (newentries == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    stack->entries = newentries;
+    stack->capacity = newcapacity;
+  }
+  stack->entries[stack->length].address = address;
+  stack->entries[stack->length].root = parent == MICOLISP_FREE_NO_PARENT? stack->length: stack->entries[parent].root;
+  stack->entries[stack->length].shadow = MICOLISP_FREE_NO_PARENT;
+  stack->entries[stack->length].visited = false;
+  stack->length += 1;
+  return 0;
+}
+
+// children are pushed above their parent, so the visited entries from the root to the top are the path, 
+// and the path works as same as cgcmemnode_history.
+// the slots find the latest visited entry of an address, 
+// and the address is recorded when the entry is in the path of the same root.
+
+// the slots are stretched without a pause: the old slots are kept, and moved a few per visit.
+// an address is in either of them, and an address left from the old slots is marked as removed.
+
+#define MICOLISP_FREE_REMOVED SIZE_MAX
+#define MICOLISP_FREE_MOVE_LENGTH 4
+
+static size_t micolisp_free_stack_home (void *address, size_t length){
+  return (size_t)(((uint64_t)(uintptr_t)address >> 3) * 0x9e3779b97f4a7c15 >> 32) & (length -1);
+}
+
+static size_t micolisp_free_stack_slot (void *address, size_t *slots, size_t length, micolisp_free_stack *stack){
+  size_t slot = micolisp_free_stack_home(address, length);
+  while (slots[slot] != 0 && (slots[slot] == MICOLISP_FREE_REMOVED || stack->entries[slots[slot] -1].address != address)){
+    slot = (slot + 1) & (length -1);
   }
-  else 
-  if (address == MICOLISP_T){
-    return 0;
+  return slot;
+}
+
+static size_t *micolisp_free_stack_find (void *address, micolisp_free_stack *stack, bool *oldp){
+  size_t slot = micolisp_free_stack_slot(address, stack->slots, stack->slotslength, stack);
+  *oldp = false;
+  if (stack->slots[slot] != 0 || stack->oldslots == NULL){ return &(stack->slots[slot]); }
+  size_t oldslot = micolisp_free_stack_slot(address, stack->oldslots, stack->oldslotslength, stack);
+  if (stack->oldslots[oldslot] == 0){ return &(stack->slots[slot]); }
+  *oldp = true;
+  return &(stack->oldslots[oldslot]);
+}
+
+static void micolisp_free_stack_move (size_t length, micolisp_free_stack *stack){
+  for (; stack->oldslots != NULL && 0 < length; length--){
+    if (stack->oldslotslength <= stack->oldslotsindex){
+      free(stack->oldslots);
+      stack->oldslots = NULL;
+      stack->oldslotslength = 0;
+      stack->oldslotsindex = 0;
+      return;
+    }
+    size_t value = stack->oldslots[stack->oldslotsindex];
+    if (value != 0 && value != MICOLISP_FREE_REMOVED){
+      stack->slots[micolisp_free_stack_slot(stack->entries[value -1].address, stack->slots, stack->slotslength, stack)] = value;
+      stack->oldslots[stack->oldslotsindex] = MICOLISP_FREE_REMOVED;
+    }
+    stack->oldslotsindex += 1;
   }
-  else 
-  if (micolisp_typep(MICOLISP_NUMBER, address, machine)){
-    if (micolisp_memory_decrease(MICOLISP_NUMBER, address, sizeof(micolisp_number), &(machine->memory)) != 0){ return 1; }
-    return 0;
+}
+
+static int micolisp_free_stack_stretch (micolisp_free_stack *stack){
+  micolisp_free_stack_move(SIZE_MAX, stack);
+  size_t newlength = MAX(64, stack->slotslength * 2);
+  size_t *newslots = calloc(newlength, sizeof(size_t));
+  if (newslots == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function calloc() was failed.");
+    return 1;
   }
-  else 
-  if (micolisp_typep(MICOLISP_SYMBOL, address, machine)){
-    if (micolisp_memory_decrease(MICOLISP_SYMBOL, address, sizeof(micolisp_symbol), &(machine->memory)) != 0){ return 1; }
-    return 0;
+  if (stack->slots != NULL){
+    stack->oldslots = stack->slots;
+    stack->oldslotslength = stack->slotslength;
+    stack->oldslotsindex = 0;
+  }
+  stack->slots = newslots;
+  stack->slotslength = newlength;
+  return 0;
+}
+
+static int micolisp_free_stack_visit (size_t index, micolisp_free_stack *stack, bool *recorded){
+  if (stack->slotslength <= stack->slotscount * 2){
+    if (micolisp_free_stack_stretch(stack) != 0){ return 1; }
+  }
+  micolisp_free_stack_move(MICOLISP_FREE_MOVE_LENGTH, stack);
+  micolisp_free_entry *entry = &(stack->entries[index]);
+  bool old;
+  size_t *slot = micolisp_free_stack_find(entry->address, stack, &old);
+  if (*slot != 0){
+    entry->shadow = *slot -1;
+  }
+  else {
+    stack->slotscount += 1;
+  }
+  if (old){
+    *slot = MICOLISP_FREE_REMOVED;
+    slot = &(stack->slots[micolisp_free_stack_slot(entry->address, stack->slots, stack->slotslength, stack)]);
+  }
+  *recorded = entry->shadow != MICOLISP_FREE_NO_PARENT && entry->root <= entry->shadow;
+  *slot = index + 1;
+  entry->visited = true;
+  return 0;
+}
+
+// the shadowed entry takes the slot back, or the slot is emptied and the following slots are shifted.
+
+static void micolisp_free_stack_leave (micolisp_free_stack *stack){
+  micolisp_free_entry *entry = &(stack->entries[stack->length -1]);
+  bool old;
+  size_t *slot = micolisp_free_stack_find(entry->address, stack, &old);
+  stack->length -= 1;
+  if (entry->shadow != MICOLISP_FREE_NO_PARENT){
+    *slot = entry->shadow + 1;
+    return;
+  }
+  stack->slotscount -= 1;
+  if (old){
+    *slot = MICOLISP_FREE_REMOVED;
+    return;
+  }
+  size_t mask = stack->slotslength -1;
+  size_t hole = slot - stack->slots;
+  for (size_t next = (hole + 1) & mask; stack->slots[next] != 0; next = (next + 1) & mask){
+    size_t home = micolisp_free_stack_home(stack->entries[stack->slots[next] -1].address, stack->slotslength);
+    if (((next - home) & mask) >= ((next - hole) & mask)){
+      stack->slots[hole] = stack->slots[next];
+      hole = next;
+    }
+  }
+  stack->slots[hole] = 0;
+}
+
+static void micolisp_free_stack_free (micolisp_free_stack *stack){
+  free(stack->entries);
+  stack->entries = NULL;
+  stack->length = 0;
+  stack->capacity = 0;
+  free(stack->slots);
+  stack->slots = NULL;
+  stack->slotslength = 0;
+  stack->slotscount = 0;
+  free(stack->oldslots);
+  stack->oldslots = NULL;
+  stack->oldslotslength = 0;
+  stack->oldslotsindex = 0;
+}
+
+static int __micolisp_decrease (size_t index, micolisp_machine *machine){
+  micolisp_free_stack *stack = &(machine->freestack);
+  void *address = stack->entries[index].address;
+  bool recorded;
+  if (micolisp_free_stack_visit(index, stack, &recorded) != 0){ return 1; }
+  if (recorded){
+    return 0; 
+  }
+  if (micolisp_sharedp(address, machine) || micolisp_segmentp(address, machine)){
+    return 0;
+  }
+  if (address == MICOLISP_NIL){
+    return 0;
+  }
+  else 
+  if (address == MICOLISP_T){
+    return 0;
+  }
+  else 
+  if (micolisp_typep(MICOLISP_NUMBER, address, machine)){
+    ((micolisp_number_cell*)address)->references -= 1;
+    if (((micolisp_number_cell*)address)->references == 0){
+      micolisp_account_free(MICOLISP_NUMBER, 1, sizeof(micolisp_number_cell), &(machine->account));
+    }
+    if (micolisp_memory_decrease(MICOLISP_NUMBER, address, sizeof(micolisp_number_cell), &(machine->memory)) != 0){ return 1; }
+    return 0;
+  }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, address, machine)){
+    ((micolisp_symbol*)address)->references -= 1;
+    if (((micolisp_symbol*)address)->references == 0){
+      if (micolisp_symbol_forget(address, machine) != 0){ return 1; }
+      micolisp_account_free(MICOLISP_SYMBOL, 1, sizeof(micolisp_symbol), &(machine->account));
+    }
+    if (micolisp_memory_decrease(MICOLISP_SYMBOL, address, sizeof(micolisp_symbol), &(machine->memory)) != 0){ return 1; }
+    return 0;
   }
   else 
   if (micolisp_typep(MICOLISP_CONS, address, machine)){
     if (micolisp_memory_decrease(MICOLISP_CONS, address, sizeof(micolisp_cons), &(machine->memory)) != 0){ return 1; }
-    ADD_CGCMEMNODE_HISTORY(address, history);
-    if (__micolisp_decrease(((micolisp_cons*)address)->car, machine, history) != 0){ return 1; }
-    if (__micolisp_decrease(((micolisp_cons*)address)->cdr, machine, history) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_cons*)address)->cdr, index, stack) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_cons*)address)->car, index, stack) != 0){ return 1; }
     return 0;
   }
   else 
   if (micolisp_typep(MICOLISP_CONS_REFERENCE, address, machine)){
     if (micolisp_memory_decrease(MICOLISP_CONS_REFERENCE, address, sizeof(micolisp_cons_reference), &(machine->memory)) != 0){ return 1; }
-    ADD_CGCMEMNODE_HISTORY(address, history);
-    if (__micolisp_decrease(((micolisp_cons_reference*)address)->cons, machine, history) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_cons_reference*)address)->cons, index, stack) != 0){ return 1; }
     return 0;
   }
   else 
@@ -910,30 +1681,27 @@ static int __micolisp_decrease (void *address, micolisp_machine *machine, cgcmem
   else 
   if (micolisp_typep(MICOLISP_USER_FUNCTION, address, machine)){
     if (micolisp_memory_decrease(MICOLISP_USER_FUNCTION, address, sizeof(micolisp_user_function), &(machine->memory)) != 0){ return 1; }
-    ADD_CGCMEMNODE_HISTORY(address, history);
-    if (__micolisp_decrease(((micolisp_user_function*)address)->args, machine, history) != 0){ return 1; }
-    if (__micolisp_decrease(((micolisp_user_function*)address)->form, machine, history) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_user_function*)address)->form, index, stack) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_user_function*)address)->args, index, stack) != 0){ return 1; }
     return 0;
   }
   else 
   if (micolisp_typep(MICOLISP_SCOPE, address, machine)){
     if (micolisp_memory_decrease(MICOLISP_SCOPE, address, sizeof(micolisp_scope), &(machine->memory)) != 0){ return 1; }
     if (micolisp_memory_decrease(MICOLISP_HASHTABLE_ENTRY, ((micolisp_scope*)address)->hashtable.entries, ((micolisp_scope*)address)->hashtable.length * sizeof(hashtable_entry), &(machine->memory)) != 0){ return 1; }
-    ADD_CGCMEMNODE_HISTORY(address, history);
     hashtable_iterator iterator = hashtable_iterate(&(((micolisp_scope*)address)->hashtable));
     hashtable_entry entry;
     while (hashtable_iterator_next(&iterator, &(((micolisp_scope*)address)->hashtable), &entry) == 0){
-      if (__micolisp_decrease(entry.key, machine, history) != 0){ return 1; }
-      if (__micolisp_decrease(entry.value, machine, history) != 0){ return 1; }
+      if (micolisp_free_stack_push(entry.value, index, stack) != 0){ return 1; }
+      if (micolisp_free_stack_push(entry.key, index, stack) != 0){ return 1; }
     }
     return 0;
   }
   else 
   if (micolisp_typep(MICOLISP_SCOPE_REFERENCE, address, machine)){
     if (micolisp_memory_decrease(MICOLISP_SCOPE_REFERENCE, address, sizeof(micolisp_scope_reference), &(machine->memory))){ return 1; }
-    ADD_CGCMEMNODE_HISTORY(address, history);
-    if (__micolisp_decrease(((micolisp_scope_reference*)address)->name, machine, history) != 0){ return 1; }
-    if (__micolisp_decrease(((micolisp_scope_reference*)address)->scope, machine, history) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_scope_reference*)address)->scope, index, stack) != 0){ return 1; }
+    if (micolisp_free_stack_push(((micolisp_scope_reference*)address)->name, index, stack) != 0){ return 1; }
     return 0;
   }
   else {
@@ -942,1436 +1710,3995 @@ static int __micolisp_decrease (void *address, micolisp_machine *machine, cgcmem
   }
 }
 
+static uint64_t micolisp_clock (){
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static void micolisp_pause_record (uint64_t start, micolisp_machine *machine){
+  uint64_t pause = micolisp_clock() - start;
+  machine->pause.count += 1;
+  machine->pause.last = pause;
+  machine->pause.max = MAX(machine->pause.max, pause);
+  machine->pause.total += pause;
+}
+
+// while pausetarget is set, the clock is read once per MICOLISP_PAUSE_CHECK_INTERVAL entries,
+// which are released objects or left entries, and the slice is recorded to the pause.
+// the entries are decreases not applied yet, not objects found unreachable by tracing.
+// a value which the mutator stores between slices is counted by its own increase,
+// so micolisp_cons_set and the scope setters need no write barrier.
+
+#define MICOLISP_PAUSE_CHECK_INTERVAL 8
+
+int micolisp_collect_step (size_t budget, micolisp_machine *machine){
+  micolisp_free_stack *stack = &(machine->freestack);
+  if (stack->length == 0){ return 0; }
+  uint64_t start = 0 < machine->pausetarget? micolisp_clock(): 0;
+  size_t released = 0;
+  size_t steps = 0;
+  while (0 < stack->length && (budget == 0 || released < budget)){
+    size_t index = stack->length -1;
+    if (stack->entries[index].visited){
+      micolisp_free_stack_leave(stack);
+    }
+    else {
+      if (__micolisp_decrease(index, machine) != 0){ return 1; }
+      released += 1;
+    }
+    steps += 1;
+    if (0 < machine->pausetarget && steps % MICOLISP_PAUSE_CHECK_INTERVAL == 0){
+      if (machine->pausetarget <= micolisp_clock() - start){ break; }
+    }
+  }
+  if (0 < machine->pausetarget){ micolisp_pause_record(start, machine); }
+  return 0;
+}
+
+int micolisp_collect (micolisp_machine *machine){
+  size_t pausetarget = machine->pausetarget;
+  machine->pausetarget = 0;
+  int status = micolisp_collect_step(0, machine);
+  machine->pausetarget = pausetarget;
+  return status;
+}
+
+
 int micolisp_increase (void *address, micolisp_machine *machine){
   MAKE_CGCMEMNODE_HISTORY(history);
   return __micolisp_increase(address, machine, history);
 }
 
 int micolisp_decrease (void *address, micolisp_machine *machine){
-  MAKE_CGCMEMNODE_HISTORY(history);
-  return __micolisp_decrease(address, machine, history);
+  if (address == MICOLISP_NIL || address == MICOLISP_T){ return 0; }
+  if (micolisp_arenap(address, machine)){ return 0; }
+  if (micolisp_free_stack_push(address, MICOLISP_FREE_NO_PARENT, &(machine->freestack)) != 0){ return 1; }
+  return micolisp_collect_step(machine->freebudget, machine);
+}
+
+// arena 
+
+#define MICOLISP_ARENA_NODE_SIZE 65536
+
+typedef struct micolisp_arena_header {
+  void *forward;
+} micolisp_arena_header;
+
+static micolisp_arena_node *make_micolisp_arena_node (size_t size, micolisp_arena_node *next){
+  micolisp_arena_node *node = malloc(sizeof(micolisp_arena_node) + size);
+  if (node == NULL){ return NULL; }
+  node->size = size;
+  node->used = 0;
+  node->next = next;
+  node->sequence = (char*)(node + 1);
+  node->mapped = 0;
+  node->committed = size;
+  node->objects = 0;
+  node->bytes = 0;
+  return node;
+}
+
+// a region is reserved with mmap and committed by MICOLISP_REGION_COMMIT_SIZE,
+// so a large arena is backed by a few mappings which may use huge pages.
+// only arena nodes are regions, because make_cgcmemnode() allocates the nodes of the heap by itself.
+
+#define MICOLISP_REGION_COMMIT_SIZE (2 * 1024 * 1024)
+
+static micolisp_arena_node *make_micolisp_region_node (size_t size, bool hugepage, micolisp_arena_node *next){
+  size_t mapped = align_size(size, MICOLISP_REGION_COMMIT_SIZE);
+  micolisp_arena_node *node = malloc(sizeof(micolisp_arena_node));
+  if (node == NULL){ return NULL; }
+  void *sequence = mmap(NULL, mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (sequence == MAP_FAILED){
+    free(node);
+    return NULL;
+  }
+#ifdef MADV_HUGEPAGE
+  // huge pages are only advised, so a kernel without them keeps small pages.
+  if (hugepage){ madvise(sequence, mapped, MADV_HUGEPAGE); }
+#endif
+  node->size = mapped;
+  node->used = 0;
+  node->next = next;
+  node->sequence = sequence;
+  node->mapped = mapped;
+  node->committed = 0;
+  node->objects = 0;
+  node->bytes = 0;
+  return node;
+}
+
+static int micolisp_region_commit (micolisp_memory_type type, size_t size, micolisp_arena_node *node, micolisp_machine *machine){
+  if (size <= node->committed){ return 0; }
+  size_t newcommitted = MIN(align_size(size, MICOLISP_REGION_COMMIT_SIZE), node->mapped);
+  if (!micolisp_account_reservablep(type, newcommitted - node->committed, &(machine->account))){
+    micolisp_error_set0(MICOLISP_MEMORY_ERROR, "memory limit was exceeded.");
+    return 1;
+  }
+  if (mprotect(node->sequence + node->committed, newcommitted - node->committed, PROT_READ | PROT_WRITE) != 0){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function mprotect() was failed.");
+    return 1;
+  }
+  micolisp_account_reserve(type, newcommitted - node->committed, &(machine->account));
+  node->committed = newcommitted;
+  return 0;
 }
 
-// lisp 
+// the pages are given back to the system, and the region is kept for the next arena.
 
-static int micolisp_print_number (micolisp_number *number, FILE *file, micolisp_machine *machine){
-  double integerpart;
-  double decimalpart = modf(*number, &integerpart);
-  (void)decimalpart;
-  if (decimalpart == 0.0 || decimalpart == -0.0){
-    fprintf(file, "%ld", (long)*number);
-    return 0;
-  }
-  else {
-    fprintf(file, "%lg", (double)*number);
-    return 0;
+static void micolisp_region_decommit (micolisp_memory_type type, micolisp_arena_node *node, micolisp_machine *machine){
+  if (0 < node->committed){
+    madvise(node->sequence, node->committed, MADV_DONTNEED);
+    mprotect(node->sequence, node->committed, PROT_NONE);
+    micolisp_account_release(type, node->committed, &(machine->account));
   }
+  node->used = 0;
+  node->committed = 0;
 }
 
-static int micolisp_print_symbol (micolisp_symbol *symbol, FILE *file, micolisp_machine *machine){
-  for (size_t index = 0; index < symbol->length; index++){
-    putc(symbol->characters[index], file);
+static void free_micolisp_arena_node (micolisp_arena_node *node){
+  if (0 < node->mapped){ munmap(node->sequence, node->mapped); }
+  free(node);
+}
+
+static void free_micolisp_arena_node_all (micolisp_arena_node *node){
+  while (node != NULL){
+    micolisp_arena_node *next = node->next;
+    free_micolisp_arena_node(node);
+    node = next;
   }
+}
+
+static micolisp_arena_node **micolisp_arena_info (micolisp_memory_type type, micolisp_arena *arena){
+  switch (type){
+    case MICOLISP_NUMBER: return &(arena->number);
+    case MICOLISP_CONS: return &(arena->cons);
+    case MICOLISP_CONS_REFERENCE: return &(arena->consreference);
+    default: return NULL;
+  }
+}
+
+static void micolisp_arena_init (micolisp_arena *arena){
+  arena->number = NULL;
+  arena->cons = NULL;
+  arena->consreference = NULL;
+  arena->ranges = NULL;
+  arena->rangeslength = 0;
+  arena->rangescapacity = 0;
+  arena->externals = NULL;
+  arena->externalslength = 0;
+  arena->externalscapacity = 0;
+  arena->depth = 0;
+  arena->active = false;
+}
+
+static void micolisp_arena_free (micolisp_arena *arena){
+  free_micolisp_arena_node_all(arena->number);
+  free_micolisp_arena_node_all(arena->cons);
+  free_micolisp_arena_node_all(arena->consreference);
+  free(arena->ranges);
+  free(arena->externals);
+  arena->number = NULL;
+  arena->cons = NULL;
+  arena->consreference = NULL;
+  arena->ranges = NULL;
+  arena->rangeslength = 0;
+  arena->rangescapacity = 0;
+  arena->externals = NULL;
+  arena->externalslength = 0;
+  arena->externalscapacity = 0;
+}
+
+// nodes are indexed by their sequences, so an address is found by a binary search.
+
+static size_t micolisp_arena_range_search (void *address, micolisp_arena *arena){
+  size_t low = 0;
+  size_t high = arena->rangeslength;
+  while (low < high){
+    size_t middle = low + (high - low) / 2;
+    if (arena->ranges[middle].node->sequence <= (char*)address){ low = middle + 1; } else { high = middle; }
+  }
+  return low;
+}
+
+static int micolisp_arena_range_add (micolisp_memory_type type, micolisp_arena_node *node, micolisp_arena *arena){
+  if (arena->rangescapacity <= arena->rangeslength){
+    size_t newcapacity = MAX(16, arena->rangescapacity * 2);
+    micolisp_arena_range *newranges = realloc(arena->ranges, newcapacity * sizeof(micolisp_arena_range));
+    if (newranges == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    arena->ranges = newranges;
+    arena->rangescapacity = newcapacity;
+  }
+  size_t index = micolisp_arena_range_search(node->sequence, arena);
+  memmove(arena->ranges + index + 1, arena->ranges + index, (arena->rangeslength - index) * sizeof(micolisp_arena_range));
+  arena->ranges[index].node = node;
+  arena->ranges[index].type = type;
+  arena->rangeslength += 1;
   return 0;
 }
 
-static int micolisp_print_list (micolisp_cons *cons, FILE *file, micolisp_machine *machine){
-  fputs("(", file);
-  for (micolisp_cons *cn = cons; cn != NULL; cn = cn->cdr){
-    if (micolisp_typep(MICOLISP_CONS, cn, machine)){
-      if (cn != cons){ fputs(" ", file); }
-      if (micolisp_print(cn->car, file, machine) != 0){ return 1; }
+static micolisp_arena_range *micolisp_arena_range_find (void *address, micolisp_arena *arena){
+  size_t index = micolisp_arena_range_search(address, arena);
+  if (index == 0){ return NULL; }
+  micolisp_arena_range *range = &(arena->ranges[index -1]);
+  return (char*)address < range->node->sequence + range->node->used? range: NULL;
+}
+
+// the latest region of the type is kept as a spare, and other nodes are freed.
+// the index is refilled by micolisp_arena_range_reset() after the release.
+
+static void micolisp_arena_release (micolisp_memory_type type, micolisp_machine *machine){
+  micolisp_arena_node **nodep = micolisp_arena_info(type, &(machine->arena));
+  micolisp_arena_node *spare = NULL;
+  micolisp_arena_node *node = *nodep;
+  while (node != NULL){
+    micolisp_arena_node *next = node->next;
+    micolisp_account_free(type, node->objects, node->bytes, &(machine->account));
+    node->objects = 0;
+    node->bytes = 0;
+    if (spare == NULL && 0 < node->mapped){
+      micolisp_region_decommit(type, node, machine);
+      node->next = NULL;
+      spare = node;
     }
     else {
-      if (cn != cons){ fputs(" . ", file); }
-      if (micolisp_print(cn, file, machine) != 0){ return 1; }
-      break;
+      micolisp_account_release(type, node->committed, &(machine->account));
+      free_micolisp_arena_node(node);
+    }
+    node = next;
+  }
+  *nodep = spare;
+}
+
+static bool micolisp_arena_typep (micolisp_memory_type type, void *address, micolisp_arena *arena){
+  micolisp_arena_range *range = micolisp_arena_range_find(address, arena);
+  return range != NULL && range->type == type;
+}
+
+bool micolisp_arenap (void *address, micolisp_machine *machine){
+  return micolisp_arena_range_find(address, &(machine->arena)) != NULL;
+}
+
+// nodes are fewer than the ranges after a release, so the index is refilled without growth.
+
+static void micolisp_arena_range_reset (micolisp_arena *arena){
+  arena->rangeslength = 0;
+  micolisp_memory_type types[] = { MICOLISP_NUMBER, MICOLISP_CONS, MICOLISP_CONS_REFERENCE };
+  for (size_t index = 0; index < sizeof(types) / sizeof(types[0]); index++){
+    for (micolisp_arena_node *node = *micolisp_arena_info(types[index], arena); node != NULL; node = node->next){
+      micolisp_arena_range_add(types[index], node, arena);
+    }
+  }
+}
+
+static micolisp_arena_header *micolisp_arena_header_of (void *address){
+  return (micolisp_arena_header*)address - 1;
+}
+
+static size_t micolisp_arena_slot_size (size_t size){
+  return align_size(sizeof(micolisp_arena_header) + size, sizeof(void*));
+}
+
+static void *micolisp_arena_allocate (micolisp_memory_type type, size_t size, micolisp_machine *machine){
+  micolisp_arena_node **nodep = micolisp_arena_info(type, &(machine->arena));
+  if (nodep == NULL){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given type could not be allocated in the arena.");
+    return NULL;
+  }
+  size_t slotsize = micolisp_arena_slot_size(size);
+  if (*nodep == NULL || (*nodep)->size < (*nodep)->used + slotsize){
+    if (0 < machine->regionsize){
+      micolisp_arena_node *node = make_micolisp_region_node(MAX(machine->regionsize, slotsize), machine->hugepage, *nodep);
+      if (node == NULL){
+        micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function mmap() was failed.");
+        return NULL;
+      }
+      if (micolisp_arena_range_add(type, node, &(machine->arena)) != 0){
+        free_micolisp_arena_node(node);
+        return NULL;
+      }
+      *nodep = node;
+    }
+    else {
+      size_t nodesize = MAX(MICOLISP_ARENA_NODE_SIZE, slotsize);
+      if (!micolisp_account_reservablep(type, nodesize, &(machine->account))){
+        micolisp_error_set0(MICOLISP_MEMORY_ERROR, "memory limit was exceeded.");
+        return NULL;
+      }
+      micolisp_arena_node *node = make_micolisp_arena_node(nodesize, *nodep);
+      if (node == NULL){
+        micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+        return NULL;
+      }
+      if (micolisp_arena_range_add(type, node, &(machine->arena)) != 0){
+        free_micolisp_arena_node(node);
+        return NULL;
+      }
+      *nodep = node;
+      micolisp_account_reserve(type, nodesize, &(machine->account));
+    }
+  }
+  if (0 < (*nodep)->mapped){
+    if (micolisp_region_commit(type, (*nodep)->used + slotsize, *nodep, machine) != 0){ return NULL; }
+  }
+  micolisp_arena_header *header = (micolisp_arena_header*)((*nodep)->sequence + (*nodep)->used);
+  header->forward = NULL;
+  (*nodep)->used += slotsize;
+  (*nodep)->objects += 1;
+  (*nodep)->bytes += size;
+  micolisp_account_allocate(type, size, true, &(machine->account));
+  return header + 1;
+}
+
+// managed objects referred from the arena are counted once,
+// and they are decreased when the arena is released.
+
+static int micolisp_arena_hold (void *value, micolisp_machine *machine){
+  if (value == MICOLISP_NIL || value == MICOLISP_T || micolisp_arenap(value, machine)){
+    return 0;
+  }
+  micolisp_arena *arena = &(machine->arena);
+  if (arena->externalscapacity <= arena->externalslength){
+    size_t newcapacity = MAX(64, arena->externalscapacity * 2);
+    void **newexternals = realloc(arena->externals, newcapacity * sizeof(void*));
+    if (newexternals == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
     }
+    arena->externals = newexternals;
+    arena->externalscapacity = newcapacity;
   }
-  fputs(")", file);
+  if (micolisp_increase(value, machine) != 0){ return 1; }
+  arena->externals[arena->externalslength] = value;
+  arena->externalslength += 1;
   return 0;
 }
 
-int micolisp_print (void *value, FILE *file, micolisp_machine *machine){
-  void *valuedereferenced;
-  if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ 
-    return 1; 
+static int __micolisp_arena_promote (void *value, micolisp_machine *machine, void **valuep){
+  if (!micolisp_arenap(value, machine)){
+    if (micolisp_increase(value, machine) != 0){ return 1; }
+    *valuep = value;
+    return 0;
+  }
+  micolisp_arena_header *header = micolisp_arena_header_of(value);
+  if (header->forward == MICOLISP_T){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not promote a circular list from the arena.");
+    return 1;
   }
-  if (valuedereferenced == MICOLISP_T){ fprintf(file, "t"); 
+  if (header->forward != NULL){
+    if (micolisp_increase(header->forward, machine) != 0){ return 1; }
+    *valuep = header->forward;
     return 0;
   }
-  else 
-  if (valuedereferenced == MICOLISP_NIL){ fprintf(file, "nil"); 
+  if (micolisp_arena_typep(MICOLISP_NUMBER, value, &(machine->arena))){
+    micolisp_number_cell *cell = micolisp_allocate_heap(MICOLISP_NUMBER, sizeof(micolisp_number_cell), machine);
+    if (cell == NULL){ return 1; }
+    cell->number = *(micolisp_number*)value;
+    cell->references = 1;
+    *valuep = &(cell->number);
     return 0;
   }
   else 
-  if (micolisp_typep(MICOLISP_NUMBER, valuedereferenced, machine)){ 
-    return micolisp_print_number(valuedereferenced, file, machine);
+  if (micolisp_arena_typep(MICOLISP_CONS_REFERENCE, value, &(machine->arena))){
+    void *cons;
+    if (__micolisp_arena_promote(((micolisp_cons_reference*)value)->cons, machine, &cons) != 0){ return 1; }
+    micolisp_cons_reference *reference = micolisp_allocate_heap(MICOLISP_CONS_REFERENCE, sizeof(micolisp_cons_reference), machine);
+    if (reference == NULL){ return 1; }
+    reference->whence = ((micolisp_cons_reference*)value)->whence;
+    reference->cons = cons;
+    *valuep = reference;
+    return 0;
   }
-  else 
-  if (micolisp_typep(MICOLISP_SYMBOL, valuedereferenced, machine)){ 
-    return micolisp_print_symbol(valuedereferenced, file, machine);
+  else {
+    // conses being copied are marked by MICOLISP_T to find a circular list.
+    // the marks are taken back on every exit, and the partly copied list is released on failure.
+    micolisp_cons *first = NULL;
+    micolisp_cons *last = NULL;
+    size_t marked = 0;
+    int status = 0;
+    void *current;
+    for (current = value; micolisp_arena_typep(MICOLISP_CONS, current, &(machine->arena)) && micolisp_arena_header_of(current)->forward == NULL; current = ((micolisp_cons*)current)->cdr){
+      micolisp_arena_header_of(current)->forward = MICOLISP_T;
+      marked += 1;
+      micolisp_cons *cons = micolisp_allocate_heap(MICOLISP_CONS, sizeof(micolisp_cons), machine);
+      if (cons == NULL){ 
+        status = 1;
+        break; 
+      }
+      cons->car = NULL;
+      cons->cdr = NULL;
+      if (last != NULL){ last->cdr = cons; } else { first = cons; }
+      last = cons;
+      if (__micolisp_arena_promote(((micolisp_cons*)current)->car, machine, &(cons->car)) != 0){ 
+        status = 1;
+        break; 
+      }
+    }
+    if (status == 0){ status = __micolisp_arena_promote(current, machine, &(last->cdr)); }
+    current = value;
+    for (; 0 < marked; marked--, current = ((micolisp_cons*)current)->cdr){
+      micolisp_arena_header_of(current)->forward = NULL;
+    }
+    if (status != 0){
+      micolisp_decrease(first, machine);
+      return 1;
+    }
+    *valuep = first;
+    return 0;
   }
-  else 
-  if (micolisp_typep(MICOLISP_CONS, valuedereferenced, machine)){ 
-    return micolisp_print_list(valuedereferenced, file, machine);
+}
+
+// copy value in the arena to the managed memory if it is.
+// the copy is remembered, so same object is promoted to same copy.
+
+static int micolisp_arena_promote (void *value, micolisp_machine *machine, void **valuep){
+  if (!micolisp_arenap(value, machine)){
+    if (micolisp_increase(value, machine) != 0){ return 1; }
+    *valuep = value;
+    return 0;
   }
-  else 
-  if (micolisp_typep(MICOLISP_C_FUNCTION, valuedereferenced, machine)){ 
-    fprintf(file, "<function #%p>", valuedereferenced); 
-    return 0; 
+  void *promoted;
+  if (__micolisp_arena_promote(value, machine, &promoted) != 0){ return 1; }
+  if (micolisp_arena_header_of(value)->forward == NULL){
+    if (micolisp_arena_hold(promoted, machine) != 0){ return 1; }
+    micolisp_arena_header_of(value)->forward = promoted;
   }
-  else 
-  if (micolisp_typep(MICOLISP_USER_FUNCTION, valuedereferenced, machine)){ 
-    fprintf(file, "<function #%p>", valuedereferenced); 
-    return 0; 
+  *valuep = promoted;
+  return 0;
+}
+
+static void micolisp_arena_activate (bool reading, micolisp_machine *machine){
+  if (0 < machine->arena.depth){
+    machine->arena.active = reading? 
+      machine->arenamode != MICOLISP_ARENA_NONE: 
+      machine->arenamode == MICOLISP_ARENA_EVAL;
   }
   else {
-    micolisp_error_set0(MICOLISP_TYPE_ERROR, "given an unknown type.");
-    return 1;
+    machine->arena.active = false;
   }
 }
 
-int micolisp_println (void *value, FILE *file, micolisp_machine *machine){
-  if (micolisp_print(value, file, machine) != 0){ return 1; }
-  putc('\n', file);
+int micolisp_arena_begin (micolisp_machine *machine){
+  machine->arena.depth += 1;
+  micolisp_arena_activate(false, machine);
   return 0;
 }
 
-// read 
+int micolisp_arena_end (micolisp_machine *machine){
+  if (machine->arena.depth == 0){
+    micolisp_error_set0(MICOLISP_ERROR, "could not end the arena, because it was not begun.");
+    return 1;
+  }
+  machine->arena.depth -= 1;
+  micolisp_arena_activate(false, machine);
+  if (machine->arena.depth == 0){
+    for (size_t index = 0; index < machine->arena.externalslength; index++){
+      if (micolisp_decrease(machine->arena.externals[index], machine) != 0){ return 1; }
+    }
+    micolisp_arena_release(MICOLISP_NUMBER, machine);
+    micolisp_arena_release(MICOLISP_CONS, machine);
+    micolisp_arena_release(MICOLISP_CONS_REFERENCE, machine);
+    micolisp_arena_range_reset(&(machine->arena));
+    free(machine->arena.externals);
+    machine->arena.externals = NULL;
+    machine->arena.externalslength = 0;
+    machine->arena.externalscapacity = 0;
+  }
+  return 0;
+}
 
-#define MICOLISP_READ_SUCCESS 0 
-#define MICOLISP_READ_ERROR 1 
-#define MICOLISP_READ_EOF 2 
-#define MICOLISP_READ_CLOSE_PAREN 3 
-#define MICOLISP_READ_DOT 4
-#define TOKEN_CHARACTERS "ABCDEFGHIJKLMNOPQRSTUVWXYZ" "abcdefghijklmnopqrstuvwxyz" "0123456789" "!#$%&*+-/:<=>?@^_|~."
-#define WHITESPACE_CHARACTERS " \t\r\n"
+// lisp 
 
-static bool parse_as_tp (char *buffer, size_t size){
-  return size == 1 && buffer[0] == 't';
-}
+// port 
 
-static bool parse_as_nilp (char *buffer, size_t size){
-  return size == 3 && buffer[0] == 'n' && buffer[1] == 'i' && buffer[2] == 'l';
+// a port collects printed characters in its buffer.
+// a port over a file writes the buffer to the file when it is full or flushed,
+// and a port without a file grows its buffer instead.
+
+static void micolisp_port_init (FILE *file, char *sequence, size_t capacity, bool owned, micolisp_port *port){
+  port->file = file;
+  port->sequence = sequence;
+  port->length = 0;
+  port->capacity = capacity;
+  port->owned = owned;
 }
 
-static bool parse_as_numberp (char *buffer, size_t size){
-  if (0 < size){
-    size_t index = 0;
-    switch (buffer[index]){
-      case '-': index += 1; break;
-      case '+': index += 1; break;
-      default: break;
-    }
-    if (index < size){
-      for (; index < size; index++){
-        if ('0' <= buffer[index] && buffer[index] <= '9'){
-          continue;
-        }
-        else 
-        if ('.' == buffer[index]){
-          index += 1;
-          if (index < size){
-            for (; index < size; index++){
-              if ('0' <= buffer[index] && buffer[index] <= '9'){
-                continue;
-              }
-              else {
-                return false;
-              }
-            }
-            return true;
-          }
-          return false;
-        }
-        else {
-          return false;
-        }
-      }
-      return true;
-    }
-    return false;
+int micolisp_port_open_file (FILE *file, micolisp_port *port){
+  char *sequence = malloc(MICOLISP_PORT_BUFFER_SIZE);
+  if (sequence == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
   }
-  return false;
+  micolisp_port_init(file, sequence, MICOLISP_PORT_BUFFER_SIZE, true, port);
+  return 0;
 }
 
-static int parse_as_number (char *buffer, size_t size, micolisp_machine *machine, void **valuep){
-  size_t index = 0; 
-  double sign;
-  if (0 < size){
-    switch (buffer[0]){
-      case '+': sign = 1.0; index += 1; break;
-      case '-': sign = -1.0; index += 1; break;
-      default: sign = 1.0; break;
-    }
+void micolisp_port_open_buffer (micolisp_port *port){
+  micolisp_port_init(NULL, NULL, 0, true, port);
+}
+
+int micolisp_port_flush (micolisp_port *port){
+  if (port->file == NULL || port->length == 0){ return 0; }
+  size_t length = port->length;
+  port->length = 0;
+  if (fwrite(port->sequence, 1, length, port->file) != length){
+    micolisp_error_set0(MICOLISP_ERROR, "could not write to the port.");
+    return 1;
   }
-  double integerpart = 0.0;
-  for (; index < size; index++){
-    if ('0' <= buffer[index] && buffer[index] <= '9'){
-      integerpart *= 10.0;
-      integerpart += buffer[index] - '0';
-    }
-    else 
-    if ('.' == buffer[index]){
-      index += 1;
-      break;
-    }
-    else {
-      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "given a non digit character.");
-      return 1;
+  return 0;
+}
+
+static int micolisp_port_reserve (size_t size, micolisp_port *port){
+  if (port->file != NULL){
+    if (port->capacity < port->length + size){
+      if (micolisp_port_flush(port) != 0){ return 1; }
     }
+    return 0;
   }
-  double decimalpart = 0.0;
-  for (double decimalbase = 0.1; index < size; index++, decimalbase /= 10.0){
-    if ('0' <= buffer[index] && buffer[index] <= '9'){
-      decimalpart += decimalbase * (buffer[index] - '0');
-    }
-    else {
-      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "given a non digit character.");
+  if (port->capacity < port->length + size){
+    size_t newcapacity = MAX(port->length + size, MAX(256, port->capacity * 2));
+    char *newsequence = realloc(port->sequence, newcapacity);
+    if (newsequence == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
       return 1;
     }
+    port->sequence = newsequence;
+    port->capacity = newcapacity;
   }
-  micolisp_number *number = micolisp_allocate_number(machine);
-  if (number == NULL){ return 1; }
-  *number = sign * (integerpart + decimalpart);
-  *valuep = number;
-  return 0;
-}
-
-static int parse_as_symbol (char *buffer, size_t size, micolisp_machine *machine, void **valuep){
-  micolisp_symbol *symbol = micolisp_allocate_symbol(buffer, size, machine);
-  if (symbol == NULL){ return 1; }
-  *valuep = symbol;
   return 0;
 }
 
-static int micolisp_read_token (FILE *file, micolisp_machine *machine, void **valuep){
-  char buffer[128] = {};
-  size_t index = 0;
-  int character;
-  while ((character = getc(file)) != EOF){
-    if (index < sizeof(buffer)){
-      if (string_find0(character, TOKEN_CHARACTERS)){
-        buffer[index] = character;
-        index += 1;
-      }
-      else {
-        ungetc(character, file);
-        break;
-      }
-    }
-    else {
-      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read token is too much long, so buffer was overflow.");
-      return 1; 
+int micolisp_port_write (char *characters, size_t size, micolisp_port *port){
+  if (micolisp_port_reserve(size, port) != 0){ return 1; }
+  // characters larger than the buffer of the file are written directly.
+  if (port->capacity < size){
+    if (fwrite(characters, 1, size, port->file) != size){
+      micolisp_error_set0(MICOLISP_ERROR, "could not write to the port.");
+      return 1;
     }
-  }
-  if (parse_as_tp(buffer, index)){
-    *valuep = MICOLISP_T;
     return 0;
   }
-  else 
-  if (parse_as_nilp(buffer, index)){
-    *valuep = MICOLISP_NIL;
+  copy(characters, size, port->sequence + port->length);
+  port->length += size;
+  return 0;
+}
+
+static int micolisp_port_put (char character, micolisp_port *port){
+  if (port->length < port->capacity){
+    port->sequence[port->length] = character;
+    port->length += 1;
     return 0;
   }
-  else 
-  if (parse_as_numberp(buffer, index)){
-    return parse_as_number(buffer, index, machine, valuep);
+  return micolisp_port_write(&character, 1, port);
+}
+
+int micolisp_port_close (micolisp_port *port){
+  int status = micolisp_port_flush(port);
+  if (port->owned){ free(port->sequence); }
+  port->sequence = NULL;
+  port->length = 0;
+  port->capacity = 0;
+  return status;
+}
+
+// number format 
+
+// numbers are formatted by Grisu2, so the digits are read back to the same double.
+// the digits are generated from a 64 bits approximation scaled by a cached power of ten.
+
+typedef struct micolisp_diyfp {
+  uint64_t f;
+  int e;
+} micolisp_diyfp;
+
+#define MICOLISP_DOUBLE_SIGNIFICAND_SIZE 52
+#define MICOLISP_DOUBLE_EXPONENT_BIAS (0x3FF + MICOLISP_DOUBLE_SIGNIFICAND_SIZE)
+#define MICOLISP_DOUBLE_HIDDEN_BIT ((uint64_t)1 << MICOLISP_DOUBLE_SIGNIFICAND_SIZE)
+#define MICOLISP_DOUBLE_SIGNIFICAND_MASK (MICOLISP_DOUBLE_HIDDEN_BIT -1)
+
+// 10^k for k = -348, -340, ..., 340 as f * 2^e.
+
+static const uint64_t MICOLISP_CACHED_POWERS_F[] = {
+  0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76, 0xcf42894a5dce35ea,
+  0x9a6bb0aa55653b2d, 0xe61acf033d1a45df, 0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f,
+  0xbe5691ef416bd60c, 0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+  0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57, 0xc21094364dfb5637,
+  0x9096ea6f3848984f, 0xd77485cb25823ac7, 0xa086cfcd97bf97f4, 0xef340a98172aace5,
+  0xb23867fb2a35b28e, 0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+  0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126, 0xb5b5ada8aaff80b8,
+  0x87625f056c7c4a8b, 0xc9bcff6034c13053, 0x964e858c91ba2655, 0xdff9772470297ebd,
+  0xa6dfbd9fb8e5b88f, 0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+  0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06, 0xaa242499697392d3,
+  0xfd87b5f28300ca0e, 0xbce5086492111aeb, 0x8cbccc096f5088cc, 0xd1b71758e219652c,
+  0x9c40000000000000, 0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+  0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068, 0x9f4f2726179a2245,
+  0xed63a231d4c4fb27, 0xb0de65388cc8ada8, 0x83c7088e1aab65db, 0xc45d1df942711d9a,
+  0x924d692ca61be758, 0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+  0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d, 0x952ab45cfa97a0b3,
+  0xde469fbd99a05fe3, 0xa59bc234db398c25, 0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece,
+  0x88fcf317f22241e2, 0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+  0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410, 0x8bab8eefb6409c1a,
+  0xd01fef10a657842c, 0x9b10a4e5e9913129, 0xe7109bfba19c0c9d, 0xac2820d9623bf429,
+  0x80444b5e7aa7cf85, 0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+  0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+
+static const int16_t MICOLISP_CACHED_POWERS_E[] = {
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+  -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+  -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+  -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+  56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+  375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+  694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+  1013, 1039, 1066,
+};
+
+static const uint64_t MICOLISP_POWERS10[] = { 
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 
+  10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL, 
+};
+
+static micolisp_diyfp micolisp_diyfp_make (uint64_t f, int e){
+  micolisp_diyfp diyfp = { f, e };
+  return diyfp;
+}
+
+static micolisp_diyfp micolisp_diyfp_of_double (double number){
+  uint64_t bits;
+  copy((char*)&number, sizeof(bits), (char*)&bits);
+  int biased = (bits >> MICOLISP_DOUBLE_SIGNIFICAND_SIZE) & 0x7FF;
+  uint64_t significand = bits & MICOLISP_DOUBLE_SIGNIFICAND_MASK;
+  if (biased != 0){
+    return micolisp_diyfp_make(significand + MICOLISP_DOUBLE_HIDDEN_BIT, biased - MICOLISP_DOUBLE_EXPONENT_BIAS);
   }
   else {
-    return parse_as_symbol(buffer, index, machine, valuep);
+    return micolisp_diyfp_make(significand, 1 - MICOLISP_DOUBLE_EXPONENT_BIAS);
   }
 }
 
-static int micolisp_read_quote (FILE *file, micolisp_machine *machine, void **valuep){
-  if (getc(file) != '\''){
-    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '\''.");
-    return 1; 
-  }
-  void *value;
-  if (micolisp_read(file, machine, &value) != 0){ return 1; }
-  micolisp_cons *quoted = micolisp_quote(value, machine);
-  if (quoted == NULL){ return 1; }
-  if (micolisp_decrease(value, machine) != 0){ return 1; } 
-  *valuep = quoted;
-  return 0;
+static micolisp_diyfp micolisp_diyfp_multiply (micolisp_diyfp x, micolisp_diyfp y){
+  const uint64_t mask = 0xFFFFFFFF;
+  uint64_t a = x.f >> 32, b = x.f & mask, c = y.f >> 32, d = y.f & mask;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask);
+  middle += (uint64_t)1 << 31; // round
+  return micolisp_diyfp_make(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64);
 }
 
-static int micolisp_read_list (FILE *file, micolisp_machine *machine, void **valuep){
-  if (getc(file) != '('){ 
-    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '('.");
-    return 1; 
+static micolisp_diyfp micolisp_diyfp_normalize (micolisp_diyfp x){
+  while ((x.f & ((uint64_t)1 << 63)) == 0){
+    x.f <<= 1;
+    x.e -= 1;
   }
-  micolisp_cons *list = NULL;
-  void *value;
-  while (true){
-    int status = micolisp_read(file, machine, &value);
-    if (status == MICOLISP_READ_SUCCESS){
-      micolisp_cons *cons = micolisp_allocate_cons(value, list, machine);
-      if (cons == NULL){ return 1; }
-      if (micolisp_decrease(value, machine) != 0){ return 1; } 
-      if (micolisp_decrease(list, machine) != 0){ return 1; } 
-      list = cons;
-    }
-    else 
-    if (status == MICOLISP_READ_CLOSE_PAREN){
-      *valuep = list_nreverse(list);
-      return 0;
-    }
-    else 
-    if (status == MICOLISP_READ_DOT){
-      void *value1;
-      void *value2;
-      if (micolisp_read(file, machine, &value1) != MICOLISP_READ_SUCCESS){ return 1; }
-      if (micolisp_read(file, machine, &value2) != MICOLISP_READ_CLOSE_PAREN){ 
-        micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "must exist close paren after value after dot.");
-        return 1; 
-      }
-      micolisp_cons *lastcons = list;
-      micolisp_cons *cons = list_nreverse(list);
-      if (micolisp_cons_set(value1, MICOLISP_CONS_CDR, lastcons, machine) != 0){ return 1; }
-      if (micolisp_decrease(value1, machine) != 0){ return 1; }
-      *valuep = cons;
-      return 0;
-    }
-    else {
-      return 1;
-    }
-  }
-  return 1; //unreachable!
+  return x;
 }
 
-static int unescape (FILE *file, char *characterp){
-  int character = getc(file);
-  switch (character){
-    case EOF: 
-      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read eof.");
-      return 1; 
-    case '0': 
-      *characterp = '\0'; 
-      return 0;
-    case 'a': 
-      *characterp = '\a'; 
-      return 0;
-    case 'b': 
-      *characterp = '\b'; 
-      return 0;
-    case 'f': 
-      *characterp = '\f'; 
-      return 0;
-    case 'n': 
-      *characterp = '\n'; 
-      return 0;
-    case 'r': 
-      *characterp = '\r'; 
-      return 0;
-    case 't': 
-      *characterp = '\t'; 
-      return 0;
-    case 'v': 
-      *characterp = '\v'; 
-      return 0;
-    default: 
-      *characterp = character; 
-      return 0;
-  }
+// the boundaries are the midpoints to the neighbor doubles.
+
+static void micolisp_diyfp_boundaries (micolisp_diyfp x, micolisp_diyfp *minusp, micolisp_diyfp *plusp){
+  micolisp_diyfp plus = micolisp_diyfp_normalize(micolisp_diyfp_make((x.f << 1) + 1, x.e - 1));
+  micolisp_diyfp minus = x.f == MICOLISP_DOUBLE_HIDDEN_BIT? 
+    micolisp_diyfp_make((x.f << 2) - 1, x.e - 2): 
+    micolisp_diyfp_make((x.f << 1) - 1, x.e - 1);
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+  *minusp = minus;
+  *plusp = plus;
 }
 
-static int micolisp_read_string (FILE *file, micolisp_machine *machine, void **valuep){
-  if (getc(file) != '"'){ 
-    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '\"'.");
-    return 1; 
+static micolisp_diyfp micolisp_cached_power (int e, int *kp){
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int k = (int)dk;
+  if (0.0 < dk - k){ k += 1; }
+  size_t index = (k >> 3) + 1;
+  *kp = -(-348 + (int)(index << 3));
+  return micolisp_diyfp_make(MICOLISP_CACHED_POWERS_F[index], MICOLISP_CACHED_POWERS_E[index]);
+}
+
+static void micolisp_grisu_round (char *buffer, size_t length, uint64_t delta, uint64_t rest, uint64_t tenkappa, uint64_t distance){
+  while (rest < distance && tenkappa <= delta - rest && 
+         (rest + tenkappa < distance || rest + tenkappa - distance < distance - rest)){
+    buffer[length -1] -= 1;
+    rest += tenkappa;
   }
-  micolisp_cons *list = NULL;
-  int character;
-  while ((character = getc(file)) != EOF){
-    if (character == '"'){
-      break;
-    }
-    else 
-    if (character == '\\'){
-      char unescaped;
-      if (unescape(file, &unescaped) != 0){ return 1; }
-      micolisp_number *number = micolisp_allocate_number(machine);
-      if (number == NULL){ return 1; }
-      *number = unescaped;
-      micolisp_cons *cons = micolisp_allocate_cons(number, list, machine);
-      if (cons == NULL){ return 1; }
-      if (micolisp_decrease(number, machine) != 0){ return 1; } 
-      if (micolisp_decrease(list, machine) != 0){ return 1; } 
-      list = cons;
+}
+
+static int micolisp_count_digits (uint32_t number){
+  int digits = 1;
+  while (digits < 10 && MICOLISP_POWERS10[digits] <= number){ digits += 1; }
+  return digits;
+}
+
+static size_t micolisp_grisu_digits (micolisp_diyfp w, micolisp_diyfp plus, uint64_t delta, char *buffer, int *kp){
+  micolisp_diyfp one = micolisp_diyfp_make((uint64_t)1 << -plus.e, plus.e);
+  uint64_t distance = plus.f - w.f;
+  uint32_t integral = (uint32_t)(plus.f >> -one.e);
+  uint64_t fraction = plus.f & (one.f - 1);
+  int kappa = micolisp_count_digits(integral);
+  size_t length = 0;
+  while (0 < kappa){
+    uint32_t digit = integral / (uint32_t)MICOLISP_POWERS10[kappa -1];
+    integral %= (uint32_t)MICOLISP_POWERS10[kappa -1];
+    if (digit != 0 || length != 0){ buffer[length++] = '0' + digit; }
+    kappa -= 1;
+    uint64_t rest = ((uint64_t)integral << -one.e) + fraction;
+    if (rest <= delta){
+      *kp += kappa;
+      micolisp_grisu_round(buffer, length, delta, rest, MICOLISP_POWERS10[kappa] << -one.e, distance);
+      return length;
     }
-    else {
-      micolisp_number *number = micolisp_allocate_number(machine);
-      if (number == NULL){ return 1; }
-      *number = character;
-      micolisp_cons *cons = micolisp_allocate_cons(number, list, machine);
-      if (cons == NULL){ return 1; }
-      if (micolisp_decrease(number, machine) != 0){ return 1; } 
-      if (micolisp_decrease(list, machine) != 0){ return 1; } 
-      list = cons;
+  }
+  while (true){
+    fraction *= 10;
+    delta *= 10;
+    char digit = (char)(fraction >> -one.e);
+    if (digit != 0 || length != 0){ buffer[length++] = '0' + digit; }
+    fraction &= one.f - 1;
+    kappa -= 1;
+    if (fraction < delta){
+      *kp += kappa;
+      micolisp_grisu_round(buffer, length, delta, fraction, one.f, -kappa < 20? distance * MICOLISP_POWERS10[-kappa]: 0);
+      return length;
     }
   }
-  *valuep = micolisp_quote(list_nreverse(list), machine);
-  return 0;
 }
 
-static void micolisp_read_comment (FILE *file){
-  int character;
-  while ((character = getc(file)) != EOF){
-    if (character == '\n'){
-      break;
-    }
-  }
+// the digits and k of positive number = digits * 10^k.
+
+static size_t micolisp_grisu2 (double number, char *buffer, int *kp){
+  micolisp_diyfp v = micolisp_diyfp_of_double(number);
+  micolisp_diyfp minus;
+  micolisp_diyfp plus;
+  micolisp_diyfp_boundaries(v, &minus, &plus);
+  micolisp_diyfp power = micolisp_cached_power(plus.e, kp);
+  micolisp_diyfp w = micolisp_diyfp_multiply(micolisp_diyfp_normalize(v), power);
+  micolisp_diyfp wplus = micolisp_diyfp_multiply(plus, power);
+  micolisp_diyfp wminus = micolisp_diyfp_multiply(minus, power);
+  wminus.f += 1;
+  wplus.f -= 1;
+  return micolisp_grisu_digits(w, wplus, wplus.f - wminus.f, buffer, kp);
 }
 
-int micolisp_read (FILE *file, micolisp_machine *machine, void **valuep){
-  int character;
-  while ((character = getc(file)) != EOF){
-    if (character == ';'){
-      micolisp_read_comment(file);
-      continue;
-    }
-    else 
-    if (character == '"'){
-      ungetc(character, file);
-      return micolisp_read_string(file, machine, valuep);
-    }
-    else 
-    if (character == '('){
-      ungetc(character, file);
-      return micolisp_read_list(file, machine, valuep);
-    }
-    else 
-    if (character == ')'){
-      return MICOLISP_READ_CLOSE_PAREN;
-    }
-    else 
-    if (character == '.'){
-      return MICOLISP_READ_DOT;
-    }
-    else 
-    if (character == '\''){
-      ungetc(character, file);
-      return micolisp_read_quote(file, machine, valuep);
-    }
-    else 
-    if (string_find0(character, WHITESPACE_CHARACTERS)){
-      continue;
-    }
-    else 
-    if (string_find0(character, TOKEN_CHARACTERS)){
-      ungetc(character, file);
-      return micolisp_read_token(file, machine, valuep);
-    }
-    else {
-      return MICOLISP_READ_ERROR; 
-    }
+static size_t micolisp_format_exponent (int exponent, char *buffer){
+  size_t length = 0;
+  if (exponent < 0){
+    buffer[length++] = '-';
+    exponent = -exponent;
   }
-  return MICOLISP_READ_EOF;
+  if (100 <= exponent){ buffer[length++] = '0' + exponent / 100; }
+  if (10 <= exponent){ buffer[length++] = '0' + exponent / 10 % 10; }
+  buffer[length++] = '0' + exponent % 10;
+  return length;
 }
 
-int micolisp_eval (void *form, micolisp_machine *machine, void **valuep){
-  void *formdereferenced;
-  if (micolisp_reference_get(form, machine, &formdereferenced) != 0){ return 1; }
-  if (micolisp_typep(MICOLISP_CONS, formdereferenced, machine)){
-    if (!listp(formdereferenced, machine)){
-      micolisp_error_set0(MICOLISP_VALUE_ERROR, "formula is an incomplete list.");
-      return 1;
-    }
-    void *function;
-    if (micolisp_eval(((micolisp_cons*)formdereferenced)->car, machine, &function) != 0){ return 1; }
-    if (micolisp_functionp(function, machine)){
-      if (micolisp_function_call(((micolisp_cons*)formdereferenced)->cdr, function, machine, valuep) != 0){ return 1; }
-      if (micolisp_decrease(function, machine) != 0){ return 1; }
-      return 0;
-    }
-    else {
-      micolisp_error_set0(MICOLISP_VALUE_ERROR, "operator in formula is non function.");
-      return 1;
-    }
+// digits are placed like 1234, 12.34, 0.001234 or 1.234e30.
+// integers are written without a point, so they are read back as they were.
+
+static size_t micolisp_format_digits (char *digits, size_t length, int k, char *buffer){
+  int point = (int)length + k;
+  size_t written = 0;
+  if ((int)length <= point && point <= 21){
+    copy(digits, length, buffer);
+    for (written = length; written < (size_t)point; written++){ buffer[written] = '0'; }
   }
   else 
-  if (micolisp_typep(MICOLISP_SYMBOL, formdereferenced, machine)){
-    void *value;
-    if (micolisp_scope_get(formdereferenced, machine, &value) != 0){ return 1; }
-    if (micolisp_increase(value, machine) != 0){ return 1; }
-    *valuep = value;
-    return 0;
+  if (0 < point && point <= 21){
+    copy(digits, point, buffer);
+    buffer[point] = '.';
+    copy(digits + point, length - point, buffer + point +1);
+    written = length +1;
+  }
+  else 
+  if (-6 < point && point <= 0){
+    buffer[written++] = '0';
+    buffer[written++] = '.';
+    for (int zero = 0; zero < -point; zero++){ buffer[written++] = '0'; }
+    copy(digits, length, buffer + written);
+    written += length;
   }
   else {
-    if (micolisp_increase(formdereferenced, machine) != 0){ return 1; }
-    *valuep = formdereferenced;
-    return 0;
+    buffer[written++] = digits[0];
+    if (1 < length){
+      buffer[written++] = '.';
+      copy(digits +1, length -1, buffer + written);
+      written += length -1;
+    }
+    buffer[written++] = 'e';
+    written += micolisp_format_exponent(point -1, buffer + written);
   }
+  return written;
 }
 
-int micolisp_eval_string (char *sequence, size_t size, micolisp_machine *machine, void **valuep){
-  FILE *file = tmpfile();
-  if (file == NULL){ 
-    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function tmpfile() was failed.");
-    return 1; 
+// precision is the digits after the point, 0 means the shortest digits which are read back to the number.
+// the buffer must have MICOLISP_NUMBER_FORMAT_LENGTH characters, and it is not terminated.
+
+size_t micolisp_format_number (micolisp_number number, size_t precision, char *buffer){
+  if (isnan(number)){
+    copy("nan", 3, buffer);
+    return 3;
   }
-  size_t wrotesize = fwrite(sequence, sizeof(char), size, file);
-  if (wrotesize < size){ 
-    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function fwrite() was failed.");
-    return 1; 
+  size_t written = 0;
+  if (signbit(number)){
+    buffer[written++] = '-';
+    number = -number;
   }
-  if (fseek(file, 0, SEEK_SET) != 0){ 
-    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function fseek() was failed.");
-    return 1; 
+  if (isinf(number)){
+    copy("inf", 3, buffer + written);
+    return written +3;
   }
-  void *value;
-  if (micolisp_read(file, machine, &value) != 0){ return 1; }
-  if (micolisp_eval(value, machine, valuep) != 0){ return 1; }
-  if (micolisp_decrease(value, machine) != 0){ return 1; }
-  if (fclose(file) != 0){ 
-    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function fclose() was failed.");
-    return 1; 
+  if (number == 0.0){
+    buffer[written++] = '0';
+    return written;
   }
-  return 0;
+  if (0 < precision && number < 1e21){
+    char fixed[MICOLISP_NUMBER_FORMAT_LENGTH];
+    int length = snprintf(fixed, sizeof(fixed), "%.*f", (int)MIN(precision, MICOLISP_NUMBER_PRECISION_MAX), number);
+    copy(fixed, length, buffer + written);
+    return written + length;
+  }
+  char digits[24];
+  int k = 0;
+  size_t length = micolisp_grisu2(number, digits, &k);
+  return written + micolisp_format_digits(digits, length, k, buffer + written);
 }
 
-int micolisp_eval_string0 (char *sequence, micolisp_machine *machine, void **valuep){
-  size_t length = string_length(sequence);
-  return micolisp_eval_string(sequence, length, machine, valuep);
+static int micolisp_print_number (micolisp_number *number, micolisp_port *port, micolisp_machine *machine){
+  char buffer[MICOLISP_NUMBER_FORMAT_LENGTH];
+  size_t length = micolisp_format_number(*number, machine->printprecision, buffer);
+  return micolisp_port_write(buffer, length, port);
 }
 
-static void print_error (FILE *file){
-  int errorcode;
-  char errormessage[MICOLISP_ERROR_INFO_MAX_LENGTH];
-  micolisp_error_get(&errorcode, errormessage);
-  fprintf(file, ">> REPL is aborted, because error was detected. <<\n");
-  fprintf(file, ">> error code = %d: %s <<\n", errorcode, errormessage); 
+static int micolisp_print_symbol (micolisp_symbol *symbol, micolisp_port *port, micolisp_machine *machine){
+  return micolisp_port_write(symbol->characters, symbol->length, port);
 }
 
-int micolisp_repl (FILE *input, FILE *output, FILE *error, micolisp_machine *machine){
-  while (true){
-    void *value;
-    int status = micolisp_read(input, machine, &value);
-    if (status == MICOLISP_READ_SUCCESS){
-      void *valueevaluated;
-      if (micolisp_eval(value, machine, &valueevaluated) != 0){ print_error(error); return 1; }
-      if (micolisp_println(valueevaluated, output, machine) != 0){ print_error(error); return 1; }
-      if (micolisp_decrease(value, machine) != 0){ print_error(error); return 1; }
-      if (micolisp_decrease(valueevaluated, machine) != 0){ print_error(error); return 1; }
-    }
-    else 
-    if (status == MICOLISP_READ_EOF){
-      return 0;
-    }
-    else 
-    if (status == MICOLISP_READ_DOT){
-      micolisp_error_set0(MICOLISP_ERROR, "read cons dot before open paren.");
-      print_error(error);
-      return 1;
-    }
-    else 
-    if (status == MICOLISP_READ_CLOSE_PAREN){
-      micolisp_error_set0(MICOLISP_ERROR, "read close paren before open paren.");
-      print_error(error);
-      return 1;
+static int micolisp_print_list (micolisp_cons *cons, micolisp_port *port, micolisp_machine *machine){
+  if (micolisp_port_put('(', port) != 0){ return 1; }
+  for (micolisp_cons *cn = cons; cn != NULL; cn = cn->cdr){
+    if (micolisp_typep(MICOLISP_CONS, cn, machine)){
+      if (cn != cons){
+        if (micolisp_port_put(' ', port) != 0){ return 1; }
+      }
+      if (micolisp_print_port(cn->car, port, machine) != 0){ return 1; }
     }
     else {
-      return 1;
+      if (cn != cons){
+        if (micolisp_port_write(" . ", 3, port) != 0){ return 1; }
+      }
+      if (micolisp_print_port(cn, port, machine) != 0){ return 1; }
+      break;
     }
   }
-  return 1; //unreachable!
+  return micolisp_port_put(')', port);
 }
 
-// builtin syntax
-
-static int make_function (micolisp_function_type type, micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args == NULL){ return 1; }
-  void *a = args->car;
-  void *forms = args->cdr;
-  if (!listp(a, machine)){ return 1; }
-  micolisp_symbol *progn = micolisp_allocate_symbol0("progn", machine);
-  if (progn == NULL){ return 1; }
-  micolisp_cons *prognforms = micolisp_allocate_cons(progn, forms, machine);
-  if (prognforms == NULL){ return 1; }
-  micolisp_user_function *function = micolisp_allocate_user_function(type, a, prognforms, machine);
-  if (function == NULL){ return 1; }
-  if (micolisp_decrease(progn, machine) != 0){ return 1; }
-  if (micolisp_decrease(prognforms, machine) != 0){ return 1; }
-  *valuep = function;
-  return 0;
+static int micolisp_print_function (void *function, micolisp_port *port){
+  char buffer[64];
+  int length = snprintf(buffer, sizeof(buffer), "<function #%p>", function);
+  return micolisp_port_write(buffer, length, port);
 }
 
-static int try_define_function (micolisp_function_type type, micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args == NULL){ return 1; }
-  void *name = args->car;
-  void *definations = args->cdr;
-  if (micolisp_typep(MICOLISP_SYMBOL, name, machine)){
-    void *function;
-    if (make_function(type, definations, machine, &function) != 0){ return 1; }
-    if (micolisp_scope_set(function, name, machine) != 0){ return 1; }
-    *valuep = function;
-    return 0;
+int micolisp_print_port (void *value, micolisp_port *port, micolisp_machine *machine){
+  void *valuedereferenced;
+  if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ 
+    return 1; 
+  }
+  if (valuedereferenced == MICOLISP_T){ 
+    return micolisp_port_put('t', port);
+  }
+  else 
+  if (valuedereferenced == MICOLISP_NIL){ 
+    return micolisp_port_write("nil", 3, port);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_NUMBER, valuedereferenced, machine)){ 
+    return micolisp_print_number(valuedereferenced, port, machine);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, valuedereferenced, machine)){ 
+    return micolisp_print_symbol(valuedereferenced, port, machine);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_CONS, valuedereferenced, machine)){ 
+    return micolisp_print_list(valuedereferenced, port, machine);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_C_FUNCTION, valuedereferenced, machine)){ 
+    return micolisp_print_function(valuedereferenced, port);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_USER_FUNCTION, valuedereferenced, machine)){ 
+    return micolisp_print_function(valuedereferenced, port);
   }
   else {
-    return make_function(type, args, machine, valuep);
+    micolisp_error_set0(MICOLISP_TYPE_ERROR, "given an unknown type.");
+    return 1;
   }
 }
 
-static int __micolisp_function (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  return try_define_function(MICOLISP_FUNCTION, args, machine, valuep);
-}
+// values printed to a file are collected in a buffer on the stack, and written at once.
 
-static int __micolisp_syntax (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  return try_define_function(MICOLISP_SYNTAX, args, machine, valuep);
+#define MICOLISP_PRINT_BUFFER_SIZE 4096
+
+int micolisp_print (void *value, FILE *file, micolisp_machine *machine){
+  char sequence[MICOLISP_PRINT_BUFFER_SIZE];
+  micolisp_port port;
+  micolisp_port_init(file, sequence, sizeof(sequence), false, &port);
+  int status = micolisp_print_port(value, &port, machine);
+  if (micolisp_port_close(&port) != 0){ return 1; }
+  return status;
 }
 
-static int __micolisp_macro (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  return try_define_function(MICOLISP_MACRO, args, machine, valuep);
+int micolisp_println (void *value, FILE *file, micolisp_machine *machine){
+  char sequence[MICOLISP_PRINT_BUFFER_SIZE];
+  micolisp_port port;
+  micolisp_port_init(file, sequence, sizeof(sequence), false, &port);
+  int status = micolisp_print_port(value, &port, machine);
+  if (status == 0){ status = micolisp_port_put('\n', &port); }
+  if (micolisp_port_close(&port) != 0){ return 1; }
+  return status;
 }
 
-static int __micolisp_progn (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *lastvalue = NULL;
-  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
-    if (micolisp_decrease(lastvalue, machine) != 0){ return 1; }
-    if (micolisp_eval(((micolisp_cons*)cons)->car, machine, &lastvalue) != 0){ return 1; }
+// the printed characters are returned in a buffer allocated by malloc(), which the caller frees.
+
+int micolisp_print_to_buffer (void *value, micolisp_machine *machine, char **sequencep, size_t *lengthp){
+  micolisp_port port;
+  micolisp_port_open_buffer(&port);
+  if (micolisp_print_port(value, &port, machine) != 0){
+    micolisp_port_close(&port);
+    return 1;
   }
-  *valuep = lastvalue;
+  *sequencep = port.sequence;
+  *lengthp = port.length;
   return 0;
 }
 
-static int __micolisp_if (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *cond;
-  void *then;
-  void *els;
-  if (list_nth(0, args, &cond) != 0){ return 1; }
-  if (list_nth(1, args, &then) != 0){ return 1; }
-  if (list_nth(2, args, &els) != 0){ return 1; }
-  void *condevaluated;
-  void *conddereferenced;
-  if (micolisp_eval(cond, machine, &condevaluated) != 0){ return 1; }
-  if (micolisp_reference_get(condevaluated, machine, &conddereferenced) != 0){ return 1; }
-  if (micolisp_decrease(conddereferenced, machine) != 0){ return 1; }
-  return micolisp_eval(conddereferenced != NULL? then: els, machine, valuep);
+// read 
+
+#define MICOLISP_READ_SUCCESS 0 
+#define MICOLISP_READ_ERROR 1 
+#define MICOLISP_READ_EOF 2 
+#define MICOLISP_READ_CLOSE_PAREN 3 
+#define MICOLISP_READ_DOT 4
+#define MICOLISP_CHARACTER_TOKEN 1
+#define MICOLISP_CHARACTER_WHITESPACE 2
+
+#if MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_LOOP
+
+#define TOKEN_CHARACTERS "ABCDEFGHIJKLMNOPQRSTUVWXYZ" "abcdefghijklmnopqrstuvwxyz" "0123456789" "!#$%&*+-/:<=>?@^_|~."
+#define WHITESPACE_CHARACTERS " \t\r\n"
+
+static bool string_find0 (char character, char *characters){
+  for (char *c = characters; *c != '\0'; c++){
+    if (*c == character){ return true; }
+  }
+  return false;
 }
 
-static int __micolisp_while (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args == NULL){ return 1; }
-  void *cond = args->car;
-  void *forms = args->cdr;
-  while (true){
-    void *condevaluated;
-    if (micolisp_eval(cond, machine, &condevaluated) != 0){ return 1; }
-    if (micolisp_decrease(condevaluated, machine) != 0){ return 1; }
-    if (condevaluated != NULL){
-      void *formsevaluated;
-      if (__micolisp_progn(forms, machine, &formsevaluated) != 0){ return 1; }
-      if (micolisp_decrease(formsevaluated, machine) != 0){ return 1; }
+#else 
+
+// classes of characters by bytes.
+// token characters are printable characters except the delimiters "'(),;[\]`{}.
+
+static const uint8_t MICOLISP_CHARACTER_CLASS[256] = {
+  ['A' ... 'Z'] = MICOLISP_CHARACTER_TOKEN, 
+  ['a' ... 'z'] = MICOLISP_CHARACTER_TOKEN, 
+  ['0' ... '9'] = MICOLISP_CHARACTER_TOKEN, 
+  ['!'] = MICOLISP_CHARACTER_TOKEN, 
+  ['#'] = MICOLISP_CHARACTER_TOKEN, 
+  ['$'] = MICOLISP_CHARACTER_TOKEN, 
+  ['%'] = MICOLISP_CHARACTER_TOKEN, 
+  ['&'] = MICOLISP_CHARACTER_TOKEN, 
+  ['*'] = MICOLISP_CHARACTER_TOKEN, 
+  ['+'] = MICOLISP_CHARACTER_TOKEN, 
+  ['-'] = MICOLISP_CHARACTER_TOKEN, 
+  ['/'] = MICOLISP_CHARACTER_TOKEN, 
+  [':'] = MICOLISP_CHARACTER_TOKEN, 
+  ['<'] = MICOLISP_CHARACTER_TOKEN, 
+  ['='] = MICOLISP_CHARACTER_TOKEN, 
+  ['>'] = MICOLISP_CHARACTER_TOKEN, 
+  ['?'] = MICOLISP_CHARACTER_TOKEN, 
+  ['@'] = MICOLISP_CHARACTER_TOKEN, 
+  ['^'] = MICOLISP_CHARACTER_TOKEN, 
+  ['_'] = MICOLISP_CHARACTER_TOKEN, 
+  ['|'] = MICOLISP_CHARACTER_TOKEN, 
+  ['~'] = MICOLISP_CHARACTER_TOKEN, 
+  ['.'] = MICOLISP_CHARACTER_TOKEN, 
+  [' '] = MICOLISP_CHARACTER_WHITESPACE, 
+  ['\t'] = MICOLISP_CHARACTER_WHITESPACE, 
+  ['\r'] = MICOLISP_CHARACTER_WHITESPACE, 
+  ['\n'] = MICOLISP_CHARACTER_WHITESPACE, 
+};
+
+#endif 
+
+static bool parse_as_tp (char *buffer, size_t size){
+  return size == 1 && buffer[0] == 't';
+}
+
+static bool parse_as_nilp (char *buffer, size_t size){
+  return size == 3 && buffer[0] == 'n' && buffer[1] == 'i' && buffer[2] == 'l';
+}
+
+// numbers are parsed in one pass. 
+// decimals of up to 19 significant digits and small exponents are exact with one multiplication or division,
+// and the others are left to strtod, so every result is correctly rounded.
+
+#define MICOLISP_NUMBER_DIGITS_MAX 19
+#define MICOLISP_NUMBER_EXACT_MAX ((uint64_t)1 << 53)
+#define MICOLISP_NUMBER_EXPONENT_MAX 100000
+
+static const double MICOLISP_EXACT_POWERS[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 
+};
+
+static bool parse_as_digitp (char character, int base){
+  switch (base){
+    case 2: return character == '0' || character == '1';
+    case 16: return ('0' <= character && character <= '9') || ('a' <= character && character <= 'f') || ('A' <= character && character <= 'F');
+    default: return '0' <= character && character <= '9';
+  }
+}
+
+static int parse_as_digit (char character){
+  if ('a' <= character && character <= 'f'){ return character - 'a' + 10; }
+  if ('A' <= character && character <= 'F'){ return character - 'A' + 10; }
+  return character - '0';
+}
+
+// integers by 0x and 0b keep their upper 64 bits, and the dropped digits are folded into the lowest bit,
+// so the conversion to double is rounded correctly.
+
+static bool parse_as_integer (char *buffer, size_t size, int base, double *numberp){
+  if (size == 0){ return false; }
+  int bits = base == 16? 4: 1;
+  uint64_t integer = 0;
+  int shift = 0;
+  bool stickyp = false;
+  for (size_t index = 0; index < size; index++){
+    if (!parse_as_digitp(buffer[index], base)){ return false; }
+    int digit = parse_as_digit(buffer[index]);
+    if ((integer >> (64 - bits)) == 0){
+      integer = (integer << bits) | digit;
     }
     else {
-      break;
+      shift += bits;
+      stickyp = stickyp || digit != 0;
     }
   }
-  *valuep = NULL;
-  return 0;
+  *numberp = ldexp((double)(integer | (stickyp? 1: 0)), shift);
+  return true;
 }
 
-static int __micolisp_var (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *name;
-  void *form;
-  void *formevaluated;
-  if (list_nth(0, args, &name) != 0){ return 1; }
-  if (list_nth(1, args, &form) != 0){ return 1; }
-  if (micolisp_eval(form, machine, &formevaluated) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_SYMBOL, name, machine)){ return 1; }
-  if (micolisp_scope_set(formevaluated, name, machine) != 0){ return 1; }
-  if (micolisp_increase(formevaluated, machine) != 0){ return 1; }
-  *valuep = formevaluated;
-  return 0;
+static bool parse_as_decimal_slowly (char *buffer, size_t size, double *numberp){
+  char stackbuffer[128];
+  char *terminated = size < sizeof(stackbuffer)? stackbuffer: malloc(size +1);
+  if (terminated == NULL){ return false; }
+  copy(buffer, size, terminated);
+  terminated[size] = '\0';
+  *numberp = strtod(terminated, NULL);
+  if (terminated != stackbuffer){ free(terminated); }
+  return true;
 }
 
-static int __micolisp_set (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *reference;
-  void *form;
-  void *referenceevaluated;
-  void *formevaluated;
-  if (list_nth(0, args, &reference) != 0){ return 1; }
-  if (list_nth(1, args, &form) != 0){ return 1; }
-  if (micolisp_eval(reference, machine, &referenceevaluated) != 0){ return 1; }
-  if (micolisp_eval(form, machine, &formevaluated) != 0){ return 1; }
-  if (!micolisp_referencep(referenceevaluated, machine)){ return 1; }
-  if (micolisp_reference_set(formevaluated, referenceevaluated, machine) != 0){ return 1; }
-  if (micolisp_decrease(referenceevaluated, machine) != 0){ return 1; }
-  *valuep = formevaluated;
-  return 0;
+// returns false when the token is not a number.
+
+static bool parse_as_numberp (char *buffer, size_t size, double *numberp){
+  size_t index = 0;
+  bool negativep = false;
+  if (index < size && (buffer[index] == '+' || buffer[index] == '-')){
+    negativep = buffer[index] == '-';
+    index += 1;
+  }
+  if (index +1 < size && buffer[index] == '0'){
+    int base = 
+      buffer[index +1] == 'x' || buffer[index +1] == 'X'? 16: 
+      buffer[index +1] == 'b' || buffer[index +1] == 'B'? 2: 10;
+    if (base != 10){
+      double integer;
+      if (!parse_as_integer(buffer + index +2, size - index -2, base, &integer)){ return false; }
+      *numberp = negativep? -integer: integer;
+      return true;
+    }
+  }
+  uint64_t mantissa = 0;
+  size_t digits = 0;
+  int64_t exponent = 0;
+  bool digitp = false;
+  bool truncatedp = false;
+  for (; index < size && '0' <= buffer[index] && buffer[index] <= '9'; index++){
+    digitp = true;
+    if (digits < MICOLISP_NUMBER_DIGITS_MAX){
+      mantissa = mantissa * 10 + (buffer[index] - '0');
+      digits += 0 < mantissa? 1: 0;
+    }
+    else {
+      exponent += 1;
+      truncatedp = truncatedp || buffer[index] != '0';
+    }
+  }
+  if (index < size && buffer[index] == '.'){
+    for (index += 1; index < size && '0' <= buffer[index] && buffer[index] <= '9'; index++){
+      digitp = true;
+      if (digits < MICOLISP_NUMBER_DIGITS_MAX){
+        mantissa = mantissa * 10 + (buffer[index] - '0');
+        digits += 0 < mantissa? 1: 0;
+        exponent -= 1;
+      }
+      else {
+        truncatedp = truncatedp || buffer[index] != '0';
+      }
+    }
+  }
+  if (!digitp){ return false; }
+  if (index < size && (buffer[index] == 'e' || buffer[index] == 'E')){
+    index += 1;
+    bool negativeexponentp = false;
+    if (index < size && (buffer[index] == '+' || buffer[index] == '-')){
+      negativeexponentp = buffer[index] == '-';
+      index += 1;
+    }
+    if (index == size){ return false; }
+    int64_t written = 0;
+    for (; index < size && '0' <= buffer[index] && buffer[index] <= '9'; index++){
+      written = MIN(MICOLISP_NUMBER_EXPONENT_MAX, written * 10 + (buffer[index] - '0'));
+    }
+    exponent += negativeexponentp? -written: written;
+  }
+  if (index != size){ return false; }
+  double number;
+  if (!truncatedp && mantissa <= MICOLISP_NUMBER_EXACT_MAX && -22 <= exponent && exponent <= 22){
+    number = (double)mantissa;
+    number = exponent < 0? number / MICOLISP_EXACT_POWERS[-exponent]: number * MICOLISP_EXACT_POWERS[exponent];
+    *numberp = negativep? -number: number;
+    return true;
+  }
+  return parse_as_decimal_slowly(buffer, size, numberp);
 }
 
-static int __micolisp_quote (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (micolisp_increase(value, machine) != 0){ return 1; }
-  *valuep = value;
+static int parse_as_number (double number, micolisp_machine *machine, void **valuep){
+  micolisp_number *numberp = micolisp_allocate_number(machine);
+  if (numberp == NULL){ return 1; }
+  *numberp = number;
+  *valuep = numberp;
   return 0;
 }
 
-// builtin function
-
-static int __micolisp_symbol (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (!listp(value, machine)){ return 1; }
-  char buffer[MICOLISP_SYMBOL_MAX_LENGTH];
-  size_t index;
-  micolisp_cons *cons;
-  for (index = 0, cons = value; index < sizeof(buffer) && cons != NULL; index++, cons = cons->cdr){
-    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-    buffer[index] = (int)*(micolisp_number*)(cons->car);
-  }
-  micolisp_symbol *symbol = micolisp_allocate_symbol(buffer, index, machine);
+static int parse_as_symbol (char *buffer, size_t size, micolisp_machine *machine, void **valuep){
+  micolisp_symbol *symbol = micolisp_allocate_symbol(buffer, size, machine);
   if (symbol == NULL){ return 1; }
   *valuep = symbol;
   return 0;
 }
 
-static int __micolisp_symbol_name (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *symbol;
-  if (list_nth(0, args, &symbol) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_SYMBOL, symbol, machine)){ return 1; }
-  micolisp_cons *list = NULL;
-  for (size_t index = 0; index < ((micolisp_symbol*)symbol)->length; index++){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = ((micolisp_symbol*)symbol)->characters[index];
-    micolisp_cons *cons = micolisp_allocate_cons(number, list, machine);
-    if (cons == NULL){ return 1; }
-    if (micolisp_decrease(number, machine) != 0){ return 1; } 
-    if (micolisp_decrease(list, machine) != 0){ return 1; } 
-    list = cons;
-  }
-  *valuep = list_nreverse(list);
-  return 0;
+// a source is read by characters from the file when its sequence is NULL.
+// otherwise the sequence is scanned by pointers, and a refillable sequence is filled from the file.
+
+#define MICOLISP_SOURCE_BUFFER_SIZE (64 * 1024)
+
+typedef struct micolisp_source {
+  FILE *file;
+  char *sequence;
+  size_t size;
+  size_t index;
+  bool refillable;
+} micolisp_source;
+
+static void micolisp_source_init_file (FILE *file, micolisp_source *source){
+  source->file = file;
+  source->sequence = NULL;
+  source->size = 0;
+  source->index = 0;
+  source->refillable = false;
 }
 
-static int __micolisp_symbol_value (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *symbol;
-  if (list_nth(0, args, &symbol) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_SYMBOL, symbol, machine)){ return 1; }
-  micolisp_scope_reference *reference = micolisp_scope_get_reference(symbol, machine);
-  if (reference == NULL){ return 1; }
-  *valuep = reference;
-  return 0;
+static void micolisp_source_init_buffer (char *sequence, size_t size, micolisp_source *source){
+  source->file = NULL;
+  source->sequence = sequence;
+  source->size = size;
+  source->index = 0;
+  source->refillable = false;
 }
 
-static int __micolisp_cons (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *car;
-  void *cdr;
-  if (list_nth(0, args, &car) != 0){ return 1; }
-  if (list_nth(1, args, &cdr) != 0){ return 1; }
-  micolisp_cons *cons = micolisp_allocate_cons(car, cdr, machine);
-  if (cons == NULL){ return 1; }
-  *valuep = cons;
-  return 0;
+// returns false at the end of the file.
+
+static bool micolisp_source_refill (micolisp_source *source){
+  if (!source->refillable){ return false; }
+  source->size = fread(source->sequence, 1, MICOLISP_SOURCE_BUFFER_SIZE, source->file);
+  source->index = 0;
+  return 0 < source->size;
 }
 
-static int __micolisp_list (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  micolisp_cons *list = NULL;
-  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
-    micolisp_cons *cn = micolisp_allocate_cons(cons->car, list, machine);
-    if (cn == NULL){ return 1; }
-    if (micolisp_decrease(list, machine) != 0){ return 1; } 
-    list = cn;
+static int micolisp_source_peek (micolisp_source *source){
+  if (source->sequence == NULL){
+    int character = getc(source->file);
+    if (character != EOF){ ungetc(character, source->file); }
+    return character;
   }
-  *valuep = list_nreverse(list);
-  return 0;
+  if (source->size <= source->index && !micolisp_source_refill(source)){ return EOF; }
+  return (unsigned char)source->sequence[source->index];
 }
 
-static int __micolisp_car (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *cons;
-  if (list_nth(0, args, &cons) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_CONS, cons, machine)){ return 1; }
-  micolisp_cons_reference *reference = micolisp_cons_get_reference(MICOLISP_CONS_CAR, cons, machine);
-  if (reference == NULL){ return 1; }
-  *valuep = reference;
-  return 0;
+static int micolisp_source_next (micolisp_source *source){
+  if (source->sequence == NULL){ return getc(source->file); }
+  if (source->size <= source->index && !micolisp_source_refill(source)){ return EOF; }
+  return (unsigned char)source->sequence[source->index++];
 }
 
-static int __micolisp_cdr (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *cons;
-  if (list_nth(0, args, &cons) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_CONS, cons, machine)){ return 1; }
-  micolisp_cons_reference *reference = micolisp_cons_get_reference(MICOLISP_CONS_CDR, cons, machine);
-  if (reference == NULL){ return 1; }
-  *valuep = reference;
-  return 0;
+static bool micolisp_token_characterp (int character){
+#if MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_LOOP
+  return character != EOF && character != '\0' && string_find0(character, TOKEN_CHARACTERS);
+#else 
+  return character != EOF && MICOLISP_CHARACTER_CLASS[(unsigned char)character] == MICOLISP_CHARACTER_TOKEN;
+#endif 
 }
 
-static int __micolisp_add (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  micolisp_number result = 0;
-  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
-    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-    result += *(micolisp_number*)(cons->car);
-  }
-  micolisp_number *resultp = micolisp_allocate_number(machine);
-  if (resultp == NULL){ return 1; }
-  *resultp = result;
-  *valuep = resultp;
-  return 0;
+static bool micolisp_whitespacep (int character){
+#if MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_LOOP
+  return character != EOF && character != '\0' && string_find0(character, WHITESPACE_CHARACTERS);
+#else 
+  return character != EOF && MICOLISP_CHARACTER_CLASS[(unsigned char)character] == MICOLISP_CHARACTER_WHITESPACE;
+#endif 
 }
 
-static int __micolisp_sub (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    micolisp_number result = *(micolisp_number*)(args->car);
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      result -= *(micolisp_number*)(cons->car);
-    }
-    micolisp_number *resultp = micolisp_allocate_number(machine);
-    if (resultp == NULL){ return 1; }
-    *resultp = result;
-    *valuep = resultp;
-    return 0;
+// scanners return the first character which ends the run in [scan, end).
+// blocks of 16 characters are classified at once with SSE2, and the rest by the table.
+
+#if MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_SSE2 && defined(__SSE2__)
+
+static int micolisp_block_whitespace (__m128i block){
+  __m128i whitespace = _mm_or_si128(
+    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))), 
+    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+  return _mm_movemask_epi8(whitespace);
+}
+
+static int micolisp_block_token (__m128i block){
+  // signed comparison also excludes the bytes over 0x7f.
+  __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(' ')), _mm_cmplt_epi8(block, _mm_set1_epi8(0x7f)));
+  __m128i delimiter = _mm_setzero_si128();
+  const char delimiters[] = "\"'(),;[\\]`{}";
+  for (size_t index = 0; index < sizeof(delimiters) -1; index++){
+    delimiter = _mm_or_si128(delimiter, _mm_cmpeq_epi8(block, _mm_set1_epi8(delimiters[index])));
   }
-  else {
-    return 1;
+  return _mm_movemask_epi8(_mm_andnot_si128(delimiter, printable));
+}
+
+static int micolisp_block_string (__m128i block){
+  __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\\')));
+  return _mm_movemask_epi8(special) ^ 0xffff;
+}
+
+#define MICOLISP_SCAN_BLOCKS(scan, end, classify) \
+  for (; scan + 16 <= end; scan += 16){ \
+    int mask = classify(_mm_loadu_si128((const __m128i*)scan)); \
+    if (mask != 0xffff){ return scan + __builtin_ctz(~mask); } \
   }
+
+#else 
+
+#define MICOLISP_SCAN_BLOCKS(scan, end, classify) 
+
+#endif 
+
+static char *micolisp_scan_whitespace (char *scan, char *end){
+  MICOLISP_SCAN_BLOCKS(scan, end, micolisp_block_whitespace);
+  while (scan < end && micolisp_whitespacep((unsigned char)*scan)){ scan++; }
+  return scan;
 }
 
-static int __micolisp_mul (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    micolisp_number result = *(micolisp_number*)(args->car);
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      result *= *(micolisp_number*)(cons->car);
-    }
-    micolisp_number *resultp = micolisp_allocate_number(machine);
-    if (resultp == NULL){ return 1; }
-    *resultp = result;
-    *valuep = resultp;
+static char *micolisp_scan_token (char *scan, char *end){
+  MICOLISP_SCAN_BLOCKS(scan, end, micolisp_block_token);
+  while (scan < end && micolisp_token_characterp((unsigned char)*scan)){ scan++; }
+  return scan;
+}
+
+static char *micolisp_scan_string (char *scan, char *end){
+  MICOLISP_SCAN_BLOCKS(scan, end, micolisp_block_string);
+  while (scan < end && *scan != '"' && *scan != '\\'){ scan++; }
+  return scan;
+}
+
+static int micolisp_parse_token (char *buffer, size_t size, micolisp_machine *machine, void **valuep){
+  double number;
+  if (parse_as_tp(buffer, size)){
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else 
+  if (parse_as_nilp(buffer, size)){
+    *valuep = MICOLISP_NIL;
     return 0;
   }
+  else 
+  if (parse_as_numberp(buffer, size, &number)){
+    return parse_as_number(number, machine, valuep);
+  }
   else {
-    return 1;
+    return parse_as_symbol(buffer, size, machine, valuep);
   }
 }
 
-static int __micolisp_div (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    micolisp_number result = *(micolisp_number*)(args->car);
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      result /= *(micolisp_number*)(cons->car);
+// dottedp is true when a dot before the token was read already.
+
+static int micolisp_read_token (micolisp_source *source, bool dottedp, micolisp_machine *machine, void **valuep){
+  // a token inside the sequence is parsed in place.
+  if (source->sequence != NULL && (!dottedp || 0 < source->index)){
+    char *start = source->sequence + source->index - (dottedp? 1: 0);
+    char *end = source->sequence + source->size;
+    char *scan = micolisp_scan_token(start, end);
+    if (scan < end || !source->refillable){
+      source->index = scan - source->sequence;
+      return micolisp_parse_token(start, scan - start, machine, valuep);
     }
-    micolisp_number *resultp = micolisp_allocate_number(machine);
-    if (resultp == NULL){ return 1; }
-    *resultp = result;
-    *valuep = resultp;
-    return 0;
   }
-  else {
-    return 1;
+  char stackbuffer[128];
+  char *buffer = stackbuffer;
+  size_t capacity = sizeof(stackbuffer);
+  size_t index = 0;
+  if (dottedp){
+    buffer[index] = '.';
+    index += 1;
+  }
+  while (micolisp_token_characterp(micolisp_source_peek(source))){
+    // long token is moved to the heap.
+    if (capacity <= index){
+      char *newbuffer = malloc(capacity * 2);
+      if (newbuffer == NULL){
+        if (buffer != stackbuffer){ free(buffer); }
+        micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+        return 1;
+      }
+      copy(buffer, index, newbuffer);
+      if (buffer != stackbuffer){ free(buffer); }
+      buffer = newbuffer;
+      capacity *= 2;
+    }
+    buffer[index] = micolisp_source_next(source);
+    index += 1;
   }
+  int status = micolisp_parse_token(buffer, index, machine, valuep);
+  if (buffer != stackbuffer){ free(buffer); }
+  return status;
 }
 
-static int __micolisp_mod (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    micolisp_number result = *(micolisp_number*)(args->car);
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      result = result - floor(result / *(micolisp_number*)(cons->car));
-    }
-    micolisp_number *resultp = micolisp_allocate_number(machine);
-    if (resultp == NULL){ return 1; }
-    *resultp = result;
-    *valuep = resultp;
-    return 0;
-  }
-  else {
-    return 1;
-  }
-}
+static int micolisp_read_form (micolisp_source*, micolisp_machine*, void**);
 
-static int __micolisp_lshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (intmax_t)integerpart1 << (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
-  }
-  else {
+static int micolisp_read_quote (micolisp_source *source, micolisp_machine *machine, void **valuep){
+  if (micolisp_source_next(source) != '\''){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '\''.");
     return 1; 
   }
+  void *value;
+  if (micolisp_read_form(source, machine, &value) != 0){ return 1; }
+  micolisp_cons *quoted = micolisp_quote(value, machine);
+  if (quoted == NULL){ return 1; }
+  if (micolisp_decrease(value, machine) != 0){ return 1; } 
+  *valuep = quoted;
+  return 0;
 }
 
-static int __micolisp_rshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (intmax_t)integerpart1 >> (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
-  }
-  else {
+static int micolisp_read_list (micolisp_source *source, micolisp_machine *machine, void **valuep){
+  if (micolisp_source_next(source) != '('){ 
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '('.");
     return 1; 
   }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  void *value;
+  while (true){
+    int status = micolisp_read_form(source, machine, &value);
+    if (status == MICOLISP_READ_SUCCESS){
+      if (micolisp_list_builder_push(value, &builder) != 0){ 
+        micolisp_decrease(value, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+    }
+    else 
+    if (status == MICOLISP_READ_CLOSE_PAREN){
+      return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+    }
+    else 
+    if (status == MICOLISP_READ_DOT){
+      void *value1;
+      void *value2;
+      if (micolisp_read_form(source, machine, &value1) != MICOLISP_READ_SUCCESS){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      if (micolisp_read_form(source, machine, &value2) != MICOLISP_READ_CLOSE_PAREN){ 
+        micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "must exist close paren after value after dot.");
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      return micolisp_list_builder_finish(value1, &builder, machine, valuep);
+    }
+    else {
+      micolisp_list_builder_abort(&builder, machine);
+      return 1;
+    }
+  }
+  return 1; //unreachable!
 }
 
-static int __micolisp_log_rshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (uintmax_t)integerpart1 >> (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
-  }
-  else {
+static char unescape_character (int character){
+  switch (character){
+    case '0': return '\0';
+    case 'a': return '\a';
+    case 'b': return '\b';
+    case 'f': return '\f';
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 't': return '\t';
+    case 'v': return '\v';
+    default: return character;
+  }
+}
+
+static int unescape (micolisp_source *source, char *characterp){
+  int character = micolisp_source_next(source);
+  if (character == EOF){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read eof.");
     return 1; 
   }
+  *characterp = unescape_character(character);
+  return 0;
 }
 
-static int __micolisp_log_not (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value, machine)){ return 1; }
-  double integerpart;
-  double decimalpart = modf(*(micolisp_number*)value, &integerpart);
-  if (abs(decimalpart) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = ~(intmax_t)integerpart;
-    *valuep = number;
-    return 0;
-  }
-  else {
+static int micolisp_read_string (micolisp_source *source, micolisp_machine *machine, void **valuep){
+  if (micolisp_source_next(source) != '"'){ 
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "first character must be '\"'.");
     return 1; 
   }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  int character;
+  while (true){
+    if (source->sequence != NULL){
+      // plain characters are found by a scan before the special ones are read.
+      char *start = source->sequence + source->index;
+      char *scan = micolisp_scan_string(start, source->sequence + source->size);
+      for (; start < scan; start++){
+        micolisp_number *number = micolisp_allocate_number(machine);
+        if (number == NULL){ 
+          micolisp_list_builder_abort(&builder, machine);
+          return 1; 
+        }
+        *number = (unsigned char)*start;
+        if (micolisp_list_builder_push(number, &builder) != 0){ 
+          micolisp_decrease(number, machine);
+          micolisp_list_builder_abort(&builder, machine);
+          return 1; 
+        }
+      }
+      source->index = scan - source->sequence;
+    }
+    if ((character = micolisp_source_next(source)) == EOF){
+      break;
+    }
+    else 
+    if (character == '"'){
+      break;
+    }
+    else 
+    if (character == '\\'){
+      char unescaped;
+      if (unescape(source, &unescaped) != 0){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      micolisp_number *number = micolisp_allocate_number(machine);
+      if (number == NULL){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      *number = unescaped;
+      if (micolisp_list_builder_push(number, &builder) != 0){ 
+        micolisp_decrease(number, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+    }
+    else {
+      micolisp_number *number = micolisp_allocate_number(machine);
+      if (number == NULL){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      *number = character;
+      if (micolisp_list_builder_push(number, &builder) != 0){ 
+        micolisp_decrease(number, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+    }
+  }
+  void *list;
+  if (micolisp_list_builder_finish(NULL, &builder, machine, &list) != 0){ return 1; }
+  *valuep = micolisp_quote(list, machine);
+  return 0;
 }
 
-static int __micolisp_log_and (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (intmax_t)integerpart1 & (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
+static void micolisp_read_comment (micolisp_source *source){
+  if (source->sequence != NULL){
+    // the rest of the line is skipped by a memory scan.
+    while (true){
+      char *start = source->sequence + source->index;
+      char *newline = memchr(start, '\n', source->size - source->index);
+      if (newline != NULL){
+        source->index = newline - source->sequence + 1;
+        return;
+      }
+      source->index = source->size;
+      if (!micolisp_source_refill(source)){ return; }
+    }
   }
-  else {
-    return 1; 
+  int character;
+  while ((character = micolisp_source_next(source)) != EOF){
+    if (character == '\n'){
+      break;
+    }
   }
 }
 
-static int __micolisp_log_or (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (intmax_t)integerpart1 | (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
-  }
-  else {
-    return 1; 
+static int micolisp_read_form (micolisp_source *source, micolisp_machine *machine, void **valuep){
+  int character;
+  while ((character = micolisp_source_peek(source)) != EOF){
+    if (character == ';'){
+      micolisp_source_next(source);
+      micolisp_read_comment(source);
+      continue;
+    }
+    else 
+    if (character == '"'){
+      return micolisp_read_string(source, machine, valuep);
+    }
+    else 
+    if (character == '('){
+      return micolisp_read_list(source, machine, valuep);
+    }
+    else 
+    if (character == ')'){
+      micolisp_source_next(source);
+      return MICOLISP_READ_CLOSE_PAREN;
+    }
+    else 
+    if (character == '.'){
+      micolisp_source_next(source);
+      // a dot before a digit begins a number like .5
+      int following = micolisp_source_peek(source);
+      if ('0' <= following && following <= '9'){
+        return micolisp_read_token(source, true, machine, valuep);
+      }
+      return MICOLISP_READ_DOT;
+    }
+    else 
+    if (character == '\''){
+      return micolisp_read_quote(source, machine, valuep);
+    }
+    else 
+    if (micolisp_whitespacep(character)){
+      if (source->sequence != NULL){
+        source->index = micolisp_scan_whitespace(source->sequence + source->index, source->sequence + source->size) - source->sequence;
+      }
+      else {
+        micolisp_source_next(source);
+      }
+      continue;
+    }
+    else 
+    if (micolisp_token_characterp(character)){
+      return micolisp_read_token(source, false, machine, valuep);
+    }
+    else {
+      micolisp_source_next(source);
+      return MICOLISP_READ_ERROR; 
+    }
   }
+  return MICOLISP_READ_EOF;
 }
 
-static int __micolisp_log_xor (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value1;
-  void *value2;
-  if (list_nth(0, args, &value1) != 0){ return 1; }
-  if (list_nth(1, args, &value2) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
-  double integerpart1;
-  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
-  double integerpart2;
-  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
-  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
-    micolisp_number *number = micolisp_allocate_number(machine);
-    if (number == NULL){ return 1; }
-    *number = (intmax_t)integerpart1 ^ (intmax_t)integerpart2;
-    *valuep = number;
-    return 0;
-  }
-  else {
-    return 1; 
+int micolisp_read (FILE *file, micolisp_machine *machine, void **valuep){
+  micolisp_source source;
+  micolisp_source_init_file(file, &source);
+  micolisp_arena_activate(true, machine);
+  int status = micolisp_read_form(&source, machine, valuep);
+  micolisp_arena_activate(false, machine);
+  return status;
+}
+
+// reads a form from the sequence at *indexp, and *indexp is moved after the form.
+
+int micolisp_read_buffer (char *sequence, size_t size, size_t *indexp, micolisp_machine *machine, void **valuep){
+  micolisp_source source;
+  micolisp_source_init_buffer(sequence, size, &source);
+  source.index = *indexp;
+  micolisp_arena_activate(true, machine);
+  int status = micolisp_read_form(&source, machine, valuep);
+  micolisp_arena_activate(false, machine);
+  *indexp = source.index;
+  return status;
+}
+
+static int micolisp_read_all (micolisp_source *source, micolisp_machine *machine, void **valuep){
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  micolisp_arena_activate(true, machine);
+  while (true){
+    void *value;
+    int status = micolisp_read_form(source, machine, &value);
+    if (status == MICOLISP_READ_SUCCESS){
+      if (micolisp_list_builder_push(value, &builder) != 0){ 
+        micolisp_decrease(value, machine);
+        status = MICOLISP_READ_ERROR; 
+      }
+    }
+    else 
+    if (status == MICOLISP_READ_DOT){
+      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read cons dot before open paren.");
+    }
+    else 
+    if (status == MICOLISP_READ_CLOSE_PAREN){
+      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read close paren before open paren.");
+    }
+    if (status == MICOLISP_READ_EOF){
+      status = micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+      micolisp_arena_activate(false, machine);
+      return status;
+    }
+    if (status != MICOLISP_READ_SUCCESS){
+      micolisp_list_builder_abort(&builder, machine);
+      micolisp_arena_activate(false, machine);
+      return 1;
+    }
   }
+  return 1; //unreachable!
 }
 
-static int __micolisp_floor (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *number;
-  if (list_nth(0, args, &number) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
-  micolisp_number *newnumber = micolisp_allocate_number(machine);
-  if (newnumber == NULL){ return 1; }
-  *newnumber = floor(*(micolisp_number*)number);
-  *valuep = newnumber;
-  return 0;
+// reads all forms to the end of the file as a list.
+// a regular file is mapped, and others like pipes are read through a refilled buffer.
+
+int micolisp_read_file (FILE *file, micolisp_machine *machine, void **valuep){
+  micolisp_source source;
+  int descriptor = fileno(file);
+  struct stat status;
+  off_t offset = ftello(file);
+  if (0 <= descriptor && 0 <= offset && fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && offset < status.st_size){
+    char *sequence = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (sequence != MAP_FAILED){
+#ifdef MADV_SEQUENTIAL
+      madvise(sequence, status.st_size, MADV_SEQUENTIAL);
+#endif
+      micolisp_source_init_buffer(sequence, status.st_size, &source);
+      source.index = offset;
+      int result = micolisp_read_all(&source, machine, valuep);
+      munmap(sequence, status.st_size);
+      fseeko(file, 0, SEEK_END);
+      return result;
+    }
+  }
+  char *buffer = malloc(MICOLISP_SOURCE_BUFFER_SIZE);
+  if (buffer == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
+  }
+  micolisp_source_init_buffer(buffer, 0, &source);
+  source.file = file;
+  source.refillable = true;
+  int result = micolisp_read_all(&source, machine, valuep);
+  free(buffer);
+  return result;
+}
+
+// parallel read 
+
+// a buffer is split at whitespaces between top level forms, and the chunks are read by threads.
+// each thread reads into the arena of its own machine.
+// when the machine reads into its arena, the symbols of each thread are interned in the machine,
+// each thread replaces its symbols in its conses, and the arena nodes are spliced into the arena of the machine,
+// so no form is copied. otherwise the forms are copied to the heap of the machine in order.
+
+#define MICOLISP_PARALLEL_CHUNK_SIZE (1024 * 1024)
+#define MICOLISP_PARALLEL_THREADS_MAX 64
+
+typedef struct micolisp_parallel_job {
+  pthread_t thread;
+  char *sequence;
+  size_t size;
+  micolisp_machine machine;
+  void *forms;
+  micolisp_cons *last; // last cons of the forms, so the forms of the next thread are linked to it.
+  hashtable symbols; // symbols of the thread -> symbols of the machine.
+  int status;
+  micolisp_error_info error;
+} micolisp_parallel_job;
+
+// strings, escapes and comments are skipped, so only parens of forms are counted.
+// a quote followed by whitespaces belongs to the next form, so it is not split there.
+
+static size_t micolisp_split_forms (char *sequence, size_t size, size_t count, size_t *boundaries){
+  size_t length = 1;
+  boundaries[0] = 0;
+  size_t depth = 0;
+  bool quotedp = false;
+  for (size_t index = 0; index < size && length < count; index++){
+    char character = sequence[index];
+    if (character == '"'){
+      for (index++; index < size && sequence[index] != '"'; index++){
+        if (sequence[index] == '\\'){ index++; }
+      }
+      quotedp = false;
+    }
+    else 
+    if (character == ';'){
+      while (index < size && sequence[index] != '\n'){ index++; }
+    }
+    else 
+    if (character == '('){
+      depth += 1;
+      quotedp = false;
+    }
+    else 
+    if (character == ')'){
+      depth = 0 < depth? depth -1: 0;
+      quotedp = false;
+    }
+    else 
+    if (micolisp_whitespacep(character)){
+      if (depth == 0 && !quotedp && size * length / count <= index){
+        boundaries[length] = index;
+        length += 1;
+      }
+    }
+    else {
+      quotedp = character == '\'';
+    }
+  }
+  boundaries[length] = size;
+  return length;
 }
 
-static int __micolisp_ceil (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *number;
-  if (list_nth(0, args, &number) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
-  micolisp_number *newnumber = micolisp_allocate_number(machine);
-  if (newnumber == NULL){ return 1; }
-  *newnumber = ceil(*(micolisp_number*)number);
-  *valuep = newnumber;
-  return 0;
+static void *micolisp_parallel_read (void *argument){
+  micolisp_parallel_job *job = argument;
+  job->forms = NULL;
+  job->status = micolisp_open(&(job->machine));
+  if (job->status == 0){
+    micolisp_source source;
+    micolisp_source_init_buffer(job->sequence, job->size, &source);
+    job->machine.arenamode = MICOLISP_ARENA_READ;
+    job->status = micolisp_arena_begin(&(job->machine)) != 0 || micolisp_read_all(&source, &(job->machine), &(job->forms)) != 0;
+  }
+  job->error = micolisp_error;
+  return NULL;
 }
 
-static int __micolisp_round (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *number;
-  if (list_nth(0, args, &number) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
-  micolisp_number *newnumber = micolisp_allocate_number(machine);
-  if (newnumber == NULL){ return 1; }
-  *newnumber = round(*(micolisp_number*)number);
-  *valuep = newnumber;
+// symbols of a thread are interned in the machine, and they are held by the arena of the machine.
+
+static int micolisp_parallel_intern (micolisp_parallel_job *job, micolisp_machine *machine){
+  hashset_iterator iterator = hashset_iterate(&(job->machine.symbol));
+  void *value;
+  while (hashset_iterator_next(&iterator, &(job->machine.symbol), &value) == 0){
+    micolisp_symbol *symbol = micolisp_allocate_symbol(((micolisp_symbol*)value)->characters, ((micolisp_symbol*)value)->length, machine);
+    if (symbol == NULL){ return 1; }
+    int status = micolisp_arena_hold(symbol, machine) != 0 || address_table_set(symbol, value, &(job->symbols)) != 0;
+    if (micolisp_decrease(symbol, machine) != 0 || status != 0){ return 1; }
+  }
   return 0;
 }
 
-static bool equal (void*, void*, micolisp_machine*);
+// conses of a thread are walked node by node on the thread, and only its own table is read.
 
-static bool equal_cons (micolisp_cons *cons1, micolisp_cons *cons2, micolisp_machine *machine){
-  return equal(cons1->car, cons2->car, machine) && equal(cons1->cdr, cons2->cdr, machine);
+static void *micolisp_parallel_patch (void *argument){
+  micolisp_parallel_job *job = argument;
+  micolisp_memory *memory = &(job->machine.memory);
+  size_t slotsize = micolisp_arena_slot_size(sizeof(micolisp_cons));
+  for (micolisp_arena_node *node = job->machine.arena.cons; node != NULL; node = node->next){
+    for (size_t offset = 0; offset + slotsize <= node->used; offset += slotsize){
+      micolisp_cons *cons = (micolisp_cons*)(node->sequence + offset + sizeof(micolisp_arena_header));
+      void *found;
+      if (micolisp_memory_typep(MICOLISP_SYMBOL, cons->car, memory) && hashtable_get(cons->car, &(job->symbols), &found) == 0){ cons->car = found; }
+      if (micolisp_memory_typep(MICOLISP_SYMBOL, cons->cdr, memory) && hashtable_get(cons->cdr, &(job->symbols), &found) == 0){ cons->cdr = found; }
+    }
+  }
+  job->last = NULL;
+  for (micolisp_cons *cons = job->forms; cons != NULL; cons = cons->cdr){ job->last = cons; }
+  return NULL;
 }
 
-static bool equal (void *value1, void *value2, micolisp_machine *machine){
-  if (micolisp_typep(MICOLISP_NUMBER, value1, machine) && micolisp_typep(MICOLISP_NUMBER, value2, machine)){
-    return *(micolisp_number*)value1 == *(micolisp_number*)value2;
-  }
-  else 
-  if (micolisp_typep(MICOLISP_CONS, value1, machine) && micolisp_typep(MICOLISP_CONS, value2, machine)){
-    return equal_cons(value1, value2, machine);
+// nodes of a thread are moved to the arena of the machine behind its current nodes,
+// so the machine keeps allocating in its own nodes.
+
+static int micolisp_parallel_splice (micolisp_parallel_job *job, micolisp_machine *machine){
+  micolisp_memory_type types[] = { MICOLISP_NUMBER, MICOLISP_CONS, MICOLISP_CONS_REFERENCE };
+  for (size_t index = 0; index < sizeof(types) / sizeof(types[0]); index++){
+    size_t committed = 0;
+    for (micolisp_arena_node *node = *micolisp_arena_info(types[index], &(job->machine.arena)); node != NULL; node = node->next){
+      committed += node->committed;
+    }
+    if (!micolisp_account_reservablep(types[index], committed, &(machine->account))){
+      micolisp_error_set0(MICOLISP_MEMORY_ERROR, "memory limit was exceeded.");
+      return 1;
+    }
   }
-  else {
-    return value1 == value2;
+  for (size_t index = 0; index < sizeof(types) / sizeof(types[0]); index++){
+    micolisp_arena_node **nodep = micolisp_arena_info(types[index], &(job->machine.arena));
+    micolisp_arena_node **machinenodep = micolisp_arena_info(types[index], &(machine->arena));
+    while (*nodep != NULL){
+      micolisp_arena_node *node = *nodep;
+      if (micolisp_arena_range_add(types[index], node, &(machine->arena)) != 0){ return 1; }
+      *nodep = node->next;
+      if (*machinenodep == NULL){
+        node->next = NULL;
+        *machinenodep = node;
+      }
+      else {
+        node->next = (*machinenodep)->next;
+        (*machinenodep)->next = node;
+      }
+      micolisp_account_reserve(types[index], node->committed, &(machine->account));
+      micolisp_account_adopt(types[index], node->objects, node->bytes, &(machine->account));
+    }
   }
+  return 0;
 }
 
-static int __micolisp_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    void *first = args->car;
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!equal(first, cons->car, machine)){
-        *valuep = MICOLISP_NIL;
-        return 0;
-      }
+// forms of a thread are copied with their symbols interned again, and the symbols are remembered by the table.
+
+static int micolisp_parallel_merge (void *value, micolisp_machine *worker, hashtable *symbols, micolisp_machine *machine, void **valuep){
+  void *found;
+  if (value == MICOLISP_NIL || value == MICOLISP_T){
+    *valuep = value;
+    return 0;
+  }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, value, worker)){
+    if (hashtable_get(value, symbols, &found) == 0){
+      if (micolisp_increase(found, machine) != 0){ return 1; }
+      *valuep = found;
+      return 0;
     }
-    *valuep = MICOLISP_T;
+    micolisp_symbol *symbol = micolisp_allocate_symbol(((micolisp_symbol*)value)->characters, ((micolisp_symbol*)value)->length, machine);
+    if (symbol == NULL){ return 1; }
+    if (address_table_set(symbol, value, symbols) != 0){ 
+      micolisp_decrease(symbol, machine);
+      return 1; 
+    }
+    *valuep = symbol;
     return 0;
   }
-  else {
-    return 1; 
+  else 
+  if (micolisp_typep(MICOLISP_NUMBER, value, worker)){
+    micolisp_number *number = micolisp_allocate_number(machine);
+    if (number == NULL){ return 1; }
+    *number = *(micolisp_number*)value;
+    *valuep = number;
+    return 0;
   }
-}
-
-static int __micolisp_unequal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (__micolisp_equal(args, machine, &value) != 0){ return 1; }
-  *valuep = value != MICOLISP_NIL? MICOLISP_NIL: MICOLISP_T;
-  return 0;
-}
-
-static int __micolisp_less (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      if (!(*(micolisp_number*)(args->car) < *(micolisp_number*)(cons->car))){
-        *valuep = MICOLISP_NIL;
-        return 0;
+  else 
+  if (micolisp_typep(MICOLISP_CONS, value, worker)){
+    micolisp_list_builder builder;
+    micolisp_list_builder_init(&builder);
+    for (; micolisp_typep(MICOLISP_CONS, value, worker); value = ((micolisp_cons*)value)->cdr){
+      void *car;
+      if (micolisp_parallel_merge(((micolisp_cons*)value)->car, worker, symbols, machine, &car) != 0){
+        micolisp_list_builder_abort(&builder, machine);
+        return 1;
+      }
+      if (micolisp_list_builder_push(car, &builder) != 0){
+        micolisp_decrease(car, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1;
       }
     }
-    *valuep = MICOLISP_T;
-    return 0;
+    void *tail;
+    if (micolisp_parallel_merge(value, worker, symbols, machine, &tail) != 0){
+      micolisp_list_builder_abort(&builder, machine);
+      return 1;
+    }
+    return micolisp_list_builder_finish(tail, &builder, machine, valuep);
   }
   else {
-    return 1; 
+    micolisp_error_set0(MICOLISP_TYPE_ERROR, "read value could not be merged.");
+    return 1;
   }
 }
 
-static int __micolisp_less_or_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      if (!(*(micolisp_number*)(args->car) <= *(micolisp_number*)(cons->car))){
-        *valuep = MICOLISP_NIL;
-        return 0;
-      }
-    }
-    *valuep = MICOLISP_T;
-    return 0;
+// a thread replaces its symbols while the following threads are still joined,
+// and the forms are linked in order after every thread is spliced.
+
+static int micolisp_parallel_join (micolisp_parallel_job *jobs, size_t started, int status, micolisp_machine *machine, void **valuep){
+  for (size_t index = 0; index < started; index++){
+    hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(jobs[index].symbols));
   }
-  else {
-    return 1; 
+  // the thread which failed is joined already, and its patch is not started.
+  size_t failed = started;
+  for (size_t index = 0; status == 0 && index < started; index++){
+    micolisp_parallel_job *job = &(jobs[index]);
+    pthread_join(job->thread, NULL);
+    if (job->status != 0){
+      micolisp_error = job->error;
+      status = 1;
+    }
+    if (status == 0){ status = micolisp_parallel_intern(job, machine); }
+    if (status == 0 && pthread_create(&(job->thread), NULL, micolisp_parallel_patch, job) != 0){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function pthread_create() was failed.");
+      status = 1;
+    }
+    if (status != 0){ failed = index; }
+  }
+  micolisp_cons *last = NULL;
+  void *forms = NULL;
+  for (size_t index = 0; index < started; index++){
+    micolisp_parallel_job *job = &(jobs[index]);
+    if (index != failed){ pthread_join(job->thread, NULL); }
+    if (status == 0){ status = micolisp_parallel_splice(job, machine); }
+    if (status == 0 && job->forms != NULL){
+      if (last == NULL){ forms = job->forms; }
+      else { last->cdr = job->forms; }
+      last = job->last;
+    }
+    free(job->symbols.entries);
+    micolisp_close(&(job->machine));
   }
+  free(jobs);
+  if (status != 0){ return 1; }
+  *valuep = forms;
+  return 0;
 }
 
-static int __micolisp_great (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      if (!(*(micolisp_number*)(args->car) > *(micolisp_number*)(cons->car))){
-        *valuep = MICOLISP_NIL;
-        return 0;
+// threads of 0 means the number of processors, and then a chunk is at least MICOLISP_PARALLEL_CHUNK_SIZE bytes.
+
+int micolisp_read_buffer_parallel (char *sequence, size_t size, size_t threads, micolisp_machine *machine, void **valuep){
+  if (threads == 0){
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = MIN(MAX(1, processors), MAX(1, size / MICOLISP_PARALLEL_CHUNK_SIZE));
+  }
+  threads = MIN(threads, MICOLISP_PARALLEL_THREADS_MAX);
+  size_t boundaries[MICOLISP_PARALLEL_THREADS_MAX + 1];
+  size_t length = micolisp_split_forms(sequence, size, threads, boundaries);
+  if (length <= 1){
+    micolisp_source source;
+    micolisp_source_init_buffer(sequence, size, &source);
+    return micolisp_read_all(&source, machine, valuep);
+  }
+  micolisp_parallel_job *jobs = malloc(length * sizeof(micolisp_parallel_job));
+  if (jobs == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
+  }
+  size_t started = 0;
+  for (; started < length; started++){
+    micolisp_parallel_job *job = &(jobs[started]);
+    job->sequence = sequence + boundaries[started];
+    job->size = boundaries[started +1] - boundaries[started];
+    if (pthread_create(&(job->thread), NULL, micolisp_parallel_read, job) != 0){ break; }
+  }
+  int status = started < length;
+  if (status != 0){ micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function pthread_create() was failed."); }
+  if (0 < machine->arena.depth && machine->arenamode != MICOLISP_ARENA_NONE){
+    return micolisp_parallel_join(jobs, started, status, machine, valuep);
+  }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  hashtable symbols;
+  for (size_t index = 0; index < started; index++){
+    micolisp_parallel_job *job = &(jobs[index]);
+    pthread_join(job->thread, NULL);
+    if (status == 0 && job->status != 0){
+      micolisp_error = job->error;
+      status = 1;
+    }
+    hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &symbols);
+    for (void *forms = job->forms; status == 0 && forms != NULL; forms = ((micolisp_cons*)forms)->cdr){
+      void *form;
+      status = micolisp_parallel_merge(((micolisp_cons*)forms)->car, &(job->machine), &symbols, machine, &form);
+      if (status == 0 && micolisp_list_builder_push(form, &builder) != 0){
+        micolisp_decrease(form, machine);
+        status = 1;
       }
     }
-    *valuep = MICOLISP_T;
-    return 0;
+    free(symbols.entries);
+    micolisp_close(&(job->machine));
   }
-  else {
-    return 1; 
+  free(jobs);
+  if (status != 0){
+    micolisp_list_builder_abort(&builder, machine);
+    return 1;
   }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
 }
 
-static int __micolisp_great_or_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (args != NULL){
-    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
-    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
-      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-      if (!(*(micolisp_number*)(args->car) >= *(micolisp_number*)(cons->car))){
-        *valuep = MICOLISP_NIL;
-        return 0;
-      }
-    }
-    *valuep = MICOLISP_T;
-    return 0;
+int micolisp_read_file_parallel (FILE *file, size_t threads, micolisp_machine *machine, void **valuep){
+  int descriptor = fileno(file);
+  struct stat status;
+  off_t offset = ftello(file);
+  if (descriptor < 0 || offset < 0 || fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size <= offset){
+    return micolisp_read_file(file, machine, valuep);
   }
-  else {
-    return 1; 
+  char *sequence = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  if (sequence == MAP_FAILED){
+    return micolisp_read_file(file, machine, valuep);
   }
+  int result = micolisp_read_buffer_parallel(sequence + offset, status.st_size - offset, threads, machine, valuep);
+  munmap(sequence, status.st_size);
+  fseeko(file, 0, SEEK_END);
+  return result;
 }
 
-static int __micolisp_numberp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  *valuep = micolisp_typep(MICOLISP_NUMBER, value, machine)? MICOLISP_T: MICOLISP_NIL;
-  return 0;
+// reader 
+
+// a reader is fed with any pieces of the input, and returns the forms completed by each piece.
+// open lists and quotes are kept as frames over one stack of values, so nothing recurses while reading,
+// and a token or a string is kept in the buffer until its end arrives.
+
+enum {
+  MICOLISP_READER_FORM,
+  MICOLISP_READER_TOKEN,
+  MICOLISP_READER_STRING,
+  MICOLISP_READER_ESCAPE,
+  MICOLISP_READER_COMMENT,
+  MICOLISP_READER_DOT, // a dot was read, and the next character decides whether it begins a number.
+};
+
+enum {
+  MICOLISP_READER_LIST,
+  MICOLISP_READER_DOTTED_LIST, // the tail is awaited after a dot.
+  MICOLISP_READER_CLOSING_LIST, // the tail was read, and a close paren is awaited.
+  MICOLISP_READER_QUOTE,
+};
+
+void micolisp_reader_init (micolisp_reader *reader){
+  *reader = (micolisp_reader){ .state = MICOLISP_READER_FORM };
 }
 
-static int __micolisp_symbolp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  *valuep = micolisp_typep(MICOLISP_SYMBOL, value, machine)? MICOLISP_T: MICOLISP_NIL;
-  return 0;
+void micolisp_reader_close (micolisp_reader *reader, micolisp_machine *machine){
+  for (size_t index = 0; index < reader->valueslength; index++){
+    micolisp_decrease(reader->values[index], machine);
+  }
+  free(reader->buffer);
+  free(reader->values);
+  free(reader->frames);
+  micolisp_reader_init(reader);
 }
 
-static int __micolisp_functionp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  *valuep = micolisp_functionp(value, machine)? MICOLISP_T: MICOLISP_NIL;
+static int micolisp_reader_reserve (void **sequencep, size_t size, size_t length, size_t *capacityp){
+  if (length <= *capacityp){ return 0; }
+  size_t newcapacity = MAX(MAX(64, length), *capacityp * 2);
+  void *newsequence = realloc(*sequencep, newcapacity * size);
+  if (newsequence == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+    return 1;
+  }
+  *sequencep = newsequence;
+  *capacityp = newcapacity;
   return 0;
 }
 
-static int __micolisp_consp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  *valuep = micolisp_typep(MICOLISP_CONS, value, machine)? MICOLISP_T: MICOLISP_NIL;
+static int micolisp_reader_buffer (char *characters, size_t size, micolisp_reader *reader){
+  if (micolisp_reader_reserve((void**)&(reader->buffer), sizeof(char), reader->length + size, &(reader->capacity)) != 0){ return 1; }
+  copy(characters, size, reader->buffer + reader->length);
+  reader->length += size;
   return 0;
 }
 
-static int __micolisp_listp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  *valuep = listp(value, machine)? MICOLISP_T: MICOLISP_NIL;
+static int micolisp_reader_push_frame (int type, micolisp_reader *reader){
+  if (micolisp_reader_reserve((void**)&(reader->frames), sizeof(micolisp_reader_frame), reader->frameslength +1, &(reader->framescapacity)) != 0){ return 1; }
+  reader->frames[reader->frameslength] = (micolisp_reader_frame){ reader->valueslength, type };
+  reader->frameslength += 1;
   return 0;
 }
 
-static int __micolisp_read (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (micolisp_read(stdin, machine, &value) != 0){ return 1; }
-  *valuep = value;
+// a completed value is quoted by the quote frames above it, and then goes to its list or the completed forms.
+
+static int micolisp_reader_complete (void *value, micolisp_reader *reader, micolisp_machine *machine){
+  while (0 < reader->frameslength && reader->frames[reader->frameslength -1].type == MICOLISP_READER_QUOTE){
+    micolisp_cons *quoted = micolisp_quote(value, machine);
+    if (quoted == NULL || micolisp_decrease(value, machine) != 0){ return 1; }
+    value = quoted;
+    reader->frameslength -= 1;
+  }
+  if (0 < reader->frameslength){
+    micolisp_reader_frame *frame = &(reader->frames[reader->frameslength -1]);
+    if (frame->type == MICOLISP_READER_CLOSING_LIST){
+      micolisp_decrease(value, machine);
+      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "must exist close paren after value after dot.");
+      return 1;
+    }
+    if (frame->type == MICOLISP_READER_DOTTED_LIST){ frame->type = MICOLISP_READER_CLOSING_LIST; }
+  }
+  if (micolisp_reader_reserve((void**)&(reader->values), sizeof(void*), reader->valueslength +1, &(reader->valuescapacity)) != 0){
+    micolisp_decrease(value, machine);
+    return 1;
+  }
+  reader->values[reader->valueslength] = value;
+  reader->valueslength += 1;
   return 0;
 }
 
-static int __micolisp_read_string (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  size_t readsize;
-  if (1 <= list_length(args)){
-    void *size;
-    if (list_nth(0, args, &size) != 0){ return 1; }
-    if (!micolisp_typep(MICOLISP_NUMBER, size, machine)){ return 1; }
-    readsize = *(micolisp_number*)size;
+static int micolisp_reader_close_list (micolisp_reader *reader, micolisp_machine *machine){
+  micolisp_reader_frame *frame = 0 < reader->frameslength? &(reader->frames[reader->frameslength -1]): NULL;
+  if (frame == NULL || frame->type == MICOLISP_READER_QUOTE){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read close paren before open paren.");
+    return 1;
   }
-  else {
-    readsize = SIZE_MAX;
+  if (frame->type == MICOLISP_READER_DOTTED_LIST){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "must exist value after dot.");
+    return 1;
   }
-  micolisp_cons *list = NULL;
-  for (size_t index = 0; index < readsize; index++){
-    int character = getc(stdin);
-    if (character != EOF){
-      micolisp_number *number = micolisp_allocate_number(machine);
-      if (number == NULL){ return 1; }
-      *number = character;
-      micolisp_cons *cons = micolisp_allocate_cons(number, list, machine);
-      if (cons == NULL){ return 1; }
-      if (micolisp_decrease(number, machine) != 0){ return 1; } 
-      if (micolisp_decrease(list, machine) != 0){ return 1; } 
-      list = cons;
-    }
-    else {
-      break;
+  void *tail = MICOLISP_NIL;
+  if (frame->type == MICOLISP_READER_CLOSING_LIST){
+    reader->valueslength -= 1;
+    tail = reader->values[reader->valueslength];
+  }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (size_t index = frame->start; index < reader->valueslength; index++){
+    if (micolisp_list_builder_push(reader->values[index], &builder) != 0){
+      micolisp_list_builder_free(&builder);
+      micolisp_decrease(tail, machine);
+      return 1;
     }
   }
-  *valuep = list_nreverse(list);
-  return 0;
+  // the values are handed over to the list.
+  reader->valueslength = frame->start;
+  reader->frameslength -= 1;
+  void *list;
+  if (micolisp_list_builder_finish(tail, &builder, machine, &list) != 0){ return 1; }
+  return micolisp_reader_complete(list, reader, machine);
 }
 
-static int __micolisp_read_line (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  size_t readsize;
-  if (1 <= list_length(args)){
-    void *size;
-    if (list_nth(0, args, &size) != 0){ return 1; }
-    if (!micolisp_typep(MICOLISP_NUMBER, size, machine)){ return 1; }
-    readsize = *(micolisp_number*)size;
+static int micolisp_reader_dot (micolisp_reader *reader){
+  micolisp_reader_frame *frame = 0 < reader->frameslength? &(reader->frames[reader->frameslength -1]): NULL;
+  if (frame == NULL || frame->type != MICOLISP_READER_LIST){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read cons dot before open paren.");
+    return 1;
   }
-  else {
-    readsize = SIZE_MAX;
+  frame->type = MICOLISP_READER_DOTTED_LIST;
+  return 0;
+}
+
+static int micolisp_reader_complete_token (micolisp_reader *reader, micolisp_machine *machine){
+  void *value;
+  reader->state = MICOLISP_READER_FORM;
+  if (micolisp_parse_token(reader->buffer, reader->length, machine, &value) != 0){ return 1; }
+  return micolisp_reader_complete(value, reader, machine);
+}
+
+static int micolisp_reader_complete_string (micolisp_reader *reader, micolisp_machine *machine){
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  reader->state = MICOLISP_READER_FORM;
+  for (size_t index = 0; index < reader->length; index++){
+    micolisp_number *number = micolisp_allocate_number(machine);
+    if (number == NULL){
+      micolisp_list_builder_abort(&builder, machine);
+      return 1;
+    }
+    *number = (unsigned char)reader->buffer[index];
+    if (micolisp_list_builder_push(number, &builder) != 0){
+      micolisp_decrease(number, machine);
+      micolisp_list_builder_abort(&builder, machine);
+      return 1;
+    }
   }
-  micolisp_cons *list = NULL;
-  for (size_t index = 0; index < readsize; index++){
-    int character = getc(stdin);
-    if (character != EOF){
-      micolisp_number *number = micolisp_allocate_number(machine);
-      if (number == NULL){ return 1; }
-      *number = character;
-      micolisp_cons *cons = micolisp_allocate_cons(number, list, machine);
-      if (cons == NULL){ return 1; }
-      if (micolisp_decrease(number, machine) != 0){ return 1; } 
-      if (micolisp_decrease(list, machine) != 0){ return 1; } 
-      list = cons;
-      if (character == '\n'){
+  void *list;
+  if (micolisp_list_builder_finish(NULL, &builder, machine, &list) != 0){ return 1; }
+  micolisp_cons *quoted = micolisp_quote(list, machine);
+  if (quoted == NULL || micolisp_decrease(list, machine) != 0){ return 1; }
+  return micolisp_reader_complete(quoted, reader, machine);
+}
+
+// a character which ends a token is read again in the form state, so the index advances only when it is consumed.
+
+static int micolisp_reader_step (char *sequence, size_t size, micolisp_reader *reader, micolisp_machine *machine){
+  char *end = sequence + size;
+  char *scan = sequence;
+  while (scan < end){
+    char character = *scan;
+    switch (reader->state){
+      case MICOLISP_READER_FORM:
+        if (micolisp_whitespacep(character)){
+          scan = micolisp_scan_whitespace(scan, end);
+          continue;
+        }
+        scan += 1;
+        if (character == ';'){
+          reader->state = MICOLISP_READER_COMMENT;
+        }
+        else 
+        if (character == '"'){
+          reader->state = MICOLISP_READER_STRING;
+          reader->length = 0;
+        }
+        else 
+        if (character == '('){
+          if (micolisp_reader_push_frame(MICOLISP_READER_LIST, reader) != 0){ return 1; }
+        }
+        else 
+        if (character == ')'){
+          if (micolisp_reader_close_list(reader, machine) != 0){ return 1; }
+        }
+        else 
+        if (character == '\''){
+          if (micolisp_reader_push_frame(MICOLISP_READER_QUOTE, reader) != 0){ return 1; }
+        }
+        else 
+        if (character == '.'){
+          reader->state = MICOLISP_READER_DOT;
+        }
+        else 
+        if (micolisp_token_characterp(character)){
+          reader->state = MICOLISP_READER_TOKEN;
+          reader->length = 0;
+          scan -= 1;
+        }
+        else {
+          micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read an unexpected character.");
+          return 1;
+        }
+        break;
+      case MICOLISP_READER_DOT:
+        // a dot before a digit begins a number like .5
+        if ('0' <= character && character <= '9'){
+          reader->state = MICOLISP_READER_TOKEN;
+          reader->length = 0;
+          if (micolisp_reader_buffer(".", 1, reader) != 0){ return 1; }
+        }
+        else {
+          reader->state = MICOLISP_READER_FORM;
+          if (micolisp_reader_dot(reader) != 0){ return 1; }
+        }
+        break;
+      case MICOLISP_READER_TOKEN: {
+        char *token = micolisp_scan_token(scan, end);
+        if (micolisp_reader_buffer(scan, token - scan, reader) != 0){ return 1; }
+        scan = token;
+        if (scan < end && micolisp_reader_complete_token(reader, machine) != 0){ return 1; }
+        break;
+      }
+      case MICOLISP_READER_STRING: {
+        char *string = micolisp_scan_string(scan, end);
+        if (micolisp_reader_buffer(scan, string - scan, reader) != 0){ return 1; }
+        scan = string;
+        if (scan < end){
+          scan += 1;
+          if (*string == '\\'){
+            reader->state = MICOLISP_READER_ESCAPE;
+          }
+          else 
+          if (micolisp_reader_complete_string(reader, machine) != 0){ 
+            return 1; 
+          }
+        }
+        break;
+      }
+      case MICOLISP_READER_ESCAPE: {
+        char unescaped = unescape_character(character);
+        scan += 1;
+        reader->state = MICOLISP_READER_STRING;
+        if (micolisp_reader_buffer(&unescaped, 1, reader) != 0){ return 1; }
+        break;
+      }
+      case MICOLISP_READER_COMMENT: {
+        char *newline = memchr(scan, '\n', end - scan);
+        scan = newline == NULL? end: newline + 1;
+        if (newline != NULL){ reader->state = MICOLISP_READER_FORM; }
         break;
       }
-    }
-    else {
-      break;
     }
   }
-  *valuep = list_nreverse(list);
   return 0;
 }
 
-static int __micolisp_eval (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  void *valueevaluated;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (micolisp_eval(value, machine, &valueevaluated) != 0){ return 1; }
-  *valuep = valueevaluated;
-  return 0;
+// the forms completed at the bottom of the stack are returned as a list, and the open ones are kept.
+
+static int micolisp_reader_take (micolisp_reader *reader, micolisp_machine *machine, void **formsp){
+  size_t length = 0 < reader->frameslength? reader->frames[0].start: reader->valueslength;
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (size_t index = 0; index < length; index++){
+    if (micolisp_list_builder_push(reader->values[index], &builder) != 0){
+      micolisp_list_builder_free(&builder);
+      return 1;
+    }
+  }
+  reader->valueslength -= length;
+  for (size_t index = 0; index < reader->valueslength; index++){
+    reader->values[index] = reader->values[length + index];
+  }
+  for (size_t index = 0; index < reader->frameslength; index++){
+    reader->frames[index].start -= length;
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, formsp);
 }
 
-static int __micolisp_eval_string (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *list;
-  if (list_nth(0, args, &list) != 0){ return 1; }
-  if (!listp(list, machine)){ return 1; }
-  size_t length = list_length(list);
-  char buffer[length];
-  size_t index;
-  micolisp_cons *cons;
-  for (index = 0, cons = list; index < length && cons != NULL; index++, cons = cons->cdr){
-    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-    buffer[index] = *(micolisp_number*)(cons->car);
+// forms are read into the heap, because they live across the pieces.
+// after an error the reader is broken, so it must be closed.
+
+int micolisp_reader_feed (char *sequence, size_t size, micolisp_reader *reader, micolisp_machine *machine, void **formsp){
+  bool active = machine->arena.active;
+  machine->arena.active = false;
+  int status = micolisp_reader_step(sequence, size, reader, machine);
+  if (status == 0){ status = micolisp_reader_take(reader, machine, formsp); }
+  machine->arena.active = active;
+  return status;
+}
+
+// the end of the input completes the last token, and anything still open is an error.
+
+int micolisp_reader_finish (micolisp_reader *reader, micolisp_machine *machine, void **formsp){
+  bool active = machine->arena.active;
+  machine->arena.active = false;
+  int status = 0;
+  if (reader->state == MICOLISP_READER_TOKEN){
+    status = micolisp_reader_complete_token(reader, machine);
   }
-  return micolisp_eval_string(buffer, length, machine, valuep);
+  else 
+  if (reader->state == MICOLISP_READER_DOT){
+    reader->state = MICOLISP_READER_FORM;
+    status = micolisp_reader_dot(reader);
+  }
+  else 
+  if (reader->state == MICOLISP_READER_STRING || reader->state == MICOLISP_READER_ESCAPE){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read eof in a string.");
+    status = 1;
+  }
+  if (status == 0 && 0 < reader->frameslength){
+    micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read eof before close paren.");
+    status = 1;
+  }
+  if (status == 0){ status = micolisp_reader_take(reader, machine, formsp); }
+  machine->arena.active = active;
+  return status;
 }
 
-static int __micolisp_print (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (micolisp_print(value, stdout, machine) != 0){ return 1; }
-  if (micolisp_increase(value, machine) != 0){ return 1; }
-  *valuep = value;
-  return 0;
+int micolisp_eval (void *form, micolisp_machine *machine, void **valuep){
+  void *formdereferenced;
+  if (micolisp_reference_get(form, machine, &formdereferenced) != 0){ return 1; }
+  if (micolisp_typep(MICOLISP_CONS, formdereferenced, machine)){
+    if (!listp(formdereferenced, machine)){
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "formula is an incomplete list.");
+      return 1;
+    }
+    void *function;
+    if (micolisp_eval(((micolisp_cons*)formdereferenced)->car, machine, &function) != 0){ return 1; }
+    if (micolisp_functionp(function, machine)){
+      if (micolisp_function_call(((micolisp_cons*)formdereferenced)->cdr, function, machine, valuep) != 0){ return 1; }
+      if (micolisp_decrease(function, machine) != 0){ return 1; }
+      return 0;
+    }
+    else {
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "operator in formula is non function.");
+      return 1;
+    }
+  }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, formdereferenced, machine)){
+    void *value;
+    if (micolisp_scope_get(formdereferenced, machine, &value) != 0){ return 1; }
+    if (micolisp_increase(value, machine) != 0){ return 1; }
+    *valuep = value;
+    return 0;
+  }
+  else {
+    if (micolisp_increase(formdereferenced, machine) != 0){ return 1; }
+    *valuep = formdereferenced;
+    return 0;
+  }
 }
 
-static int __micolisp_println (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+static int micolisp_read_eval (micolisp_source *source, micolisp_machine *machine, void **valuep){
   void *value;
-  if (list_nth(0, args, &value) != 0){ return 1; }
-  if (micolisp_println(value, stdout, machine) != 0){ return 1; }
-  if (micolisp_increase(value, machine) != 0){ return 1; }
-  *valuep = value;
+  void *valueevaluated;
+  micolisp_arena_activate(true, machine);
+  int status = micolisp_read_form(source, machine, &value);
+  micolisp_arena_activate(false, machine);
+  if (status != MICOLISP_READ_SUCCESS){ return status; }
+  if (micolisp_eval(value, machine, &valueevaluated) != 0){ return 1; }
+  if (micolisp_arena_promote(valueevaluated, machine, valuep) != 0){ return 1; }
+  if (micolisp_decrease(valueevaluated, machine) != 0){ return 1; }
+  if (micolisp_decrease(value, machine) != 0){ return 1; }
   return 0;
 }
 
-static int __micolisp_write (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *list;
-  if (list_nth(0, args, &list) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_CONS, list, machine)){ return 1; }
-  for (micolisp_cons *cons = list; cons != NULL; cons = cons->cdr){
-    void *consdereferenced;
-    if (micolisp_reference_get(cons, machine, &consdereferenced) != 0){ return 1; }
-    if (!micolisp_typep(MICOLISP_CONS, consdereferenced, machine)){ return 1; }
-    if (!micolisp_typep(MICOLISP_NUMBER, ((micolisp_cons*)consdereferenced)->car, machine)){ return 1; }
-    putchar((int)*(micolisp_number*)((micolisp_cons*)consdereferenced)->car);
+// the sequence is read in place, so no file is made for it.
+
+int micolisp_eval_string (char *sequence, size_t size, micolisp_machine *machine, void **valuep){
+  micolisp_source source;
+  micolisp_source_init_buffer(sequence, size, &source);
+  if (micolisp_arena_begin(machine) != 0){ return 1; }
+  int status = micolisp_read_eval(&source, machine, valuep);
+  if (micolisp_arena_end(machine) != 0){ return 1; }
+  return status == 0? 0: 1;
+}
+
+// all forms are evaluated in order, each in its own arena, and the value of the last is returned.
+// empty sequence is evaluated to nil.
+
+int micolisp_eval_string_all (char *sequence, size_t size, micolisp_machine *machine, void **valuep){
+  micolisp_source source;
+  micolisp_source_init_buffer(sequence, size, &source);
+  void *last = MICOLISP_NIL;
+  while (true){
+    void *value;
+    if (micolisp_arena_begin(machine) != 0){ return 1; }
+    int status = micolisp_read_eval(&source, machine, &value);
+    if (micolisp_arena_end(machine) != 0){ return 1; }
+    if (status == MICOLISP_READ_EOF){
+      *valuep = last;
+      return 0;
+    }
+    if (status == MICOLISP_READ_DOT){
+      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read cons dot before open paren.");
+    }
+    else 
+    if (status == MICOLISP_READ_CLOSE_PAREN){
+      micolisp_error_set0(MICOLISP_SYNTAX_ERROR, "read close paren before open paren.");
+    }
+    if (status != 0){
+      micolisp_decrease(last, machine);
+      return 1;
+    }
+    if (micolisp_decrease(last, machine) != 0){ return 1; }
+    last = value;
   }
-  return 0;
+  return 1; //unreachable!
 }
 
-static int __micolisp_writeln (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  if (__micolisp_write(args, machine, valuep) != 0){ return 1; }
-  putchar('\n');
-  return 0;
+int micolisp_eval_string0 (char *sequence, micolisp_machine *machine, void **valuep){
+  size_t length = string_length(sequence);
+  return micolisp_eval_string(sequence, length, machine, valuep);
 }
 
-static int __micolisp_error (micolisp_cons *args, micolisp_machine *machine, void **valuep){
-  void *errorcode;
-  void *errormessage;
-  if (list_nth(0, args, &errorcode) != 0){ return 1; }
-  if (list_nth(1, args, &errormessage) != 0){ return 1; }
-  if (!micolisp_typep(MICOLISP_NUMBER, errorcode, machine)){ return 1; }
-  if (!listp(errormessage, machine)){ return 1; }
-  char buffer[MICOLISP_ERROR_INFO_MAX_LENGTH];
-  size_t index;
-  micolisp_cons *cons;
-  for (index = 0, cons = errormessage; index < MICOLISP_ERROR_INFO_MAX_LENGTH && cons != NULL; index++, cons = cons->cdr){
-    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
-    buffer[index] = *(micolisp_number*)(cons->car);
-  }
-  micolisp_error_set(*(micolisp_number*)errorcode, buffer, index);
-  return 1;
+int micolisp_eval_string_all0 (char *sequence, micolisp_machine *machine, void **valuep){
+  size_t length = string_length(sequence);
+  return micolisp_eval_string_all(sequence, length, machine, valuep);
 }
 
-// setup syntax 
+static void print_error (FILE *file){
+  int errorcode;
+  char errormessage[MICOLISP_ERROR_INFO_MAX_LENGTH];
+  micolisp_error_get(&errorcode, errormessage);
+  fprintf(file, ">> REPL is aborted, because error was detected. <<\n");
+  fprintf(file, ">> error code = %d: %s <<\n", errorcode, errormessage); 
+}
 
-static int setup_builtin_syntax (micolisp_machine *machine){
-  // define function 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("function", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_function, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+// a form is read, evaluated and printed in the arena begun by micolisp_repl(),
+// and errors are printed before the arena is ended.
+
+static int micolisp_repl_form (FILE *input, FILE *output, FILE *error, micolisp_machine *machine){
+  void *value;
+  int status = micolisp_read(input, machine, &value);
+  if (status == MICOLISP_READ_SUCCESS){
+    void *valueevaluated;
+    if (micolisp_eval(value, machine, &valueevaluated) != 0){
+      print_error(error);
+      micolisp_decrease(value, machine);
+      return 1;
+    }
+    status = micolisp_println(valueevaluated, output, machine);
+    if (status != 0){ print_error(error); }
+    if (micolisp_decrease(value, machine) != 0 && status == 0){ print_error(error); status = 1; }
+    if (micolisp_decrease(valueevaluated, machine) != 0 && status == 0){ print_error(error); status = 1; }
+    return status;
   }
-  // define syntax 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("syntax", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_syntax, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else 
+  if (status == MICOLISP_READ_EOF){
+    return MICOLISP_READ_EOF;
   }
-  // define macro 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("macro", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_macro, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else 
+  if (status == MICOLISP_READ_DOT){
+    micolisp_error_set0(MICOLISP_ERROR, "read cons dot before open paren.");
+    print_error(error);
+    return 1;
   }
-  // define progn 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("progn", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_progn, machine);
+  else 
+  if (status == MICOLISP_READ_CLOSE_PAREN){
+    micolisp_error_set0(MICOLISP_ERROR, "read close paren before open paren.");
+    print_error(error);
+    return 1;
+  }
+  else {
+    return 1;
+  }
+}
+
+int micolisp_repl (FILE *input, FILE *output, FILE *error, micolisp_machine *machine){
+  while (true){
+    if (micolisp_arena_begin(machine) != 0){ print_error(error); return 1; }
+    int status = micolisp_repl_form(input, output, error, machine);
+    if (micolisp_arena_end(machine) != 0){ print_error(error); return 1; }
+    if (status == MICOLISP_READ_EOF){ return 0; }
+    if (status != 0){ return 1; }
+  }
+  return 1; //unreachable!
+}
+
+// builtin syntax
+
+static int make_function (micolisp_function_type type, micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args == NULL){ return 1; }
+  void *a = args->car;
+  void *forms = args->cdr;
+  if (!listp(a, machine)){ return 1; }
+  micolisp_symbol *progn = micolisp_allocate_symbol0("progn", machine);
+  if (progn == NULL){ return 1; }
+  micolisp_cons *prognforms = micolisp_allocate_cons(progn, forms, machine);
+  if (prognforms == NULL){ return 1; }
+  micolisp_user_function *function = micolisp_allocate_user_function(type, a, prognforms, machine);
+  if (function == NULL){ return 1; }
+  if (micolisp_decrease(progn, machine) != 0){ return 1; }
+  if (micolisp_decrease(prognforms, machine) != 0){ return 1; }
+  *valuep = function;
+  return 0;
+}
+
+static int try_define_function (micolisp_function_type type, micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args == NULL){ return 1; }
+  void *name = args->car;
+  void *definations = args->cdr;
+  if (micolisp_typep(MICOLISP_SYMBOL, name, machine)){
+    void *function;
+    if (make_function(type, definations, machine, &function) != 0){ return 1; }
+    if (micolisp_scope_set(function, name, machine) != 0){ return 1; }
+    *valuep = function;
+    return 0;
+  }
+  else {
+    return make_function(type, args, machine, valuep);
+  }
+}
+
+static int __micolisp_function (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  return try_define_function(MICOLISP_FUNCTION, args, machine, valuep);
+}
+
+static int __micolisp_syntax (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  return try_define_function(MICOLISP_SYNTAX, args, machine, valuep);
+}
+
+static int __micolisp_macro (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  return try_define_function(MICOLISP_MACRO, args, machine, valuep);
+}
+
+static int __micolisp_progn (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *lastvalue = NULL;
+  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
+    if (micolisp_decrease(lastvalue, machine) != 0){ return 1; }
+    if (micolisp_eval(((micolisp_cons*)cons)->car, machine, &lastvalue) != 0){ return 1; }
+  }
+  *valuep = lastvalue;
+  return 0;
+}
+
+static int __micolisp_if (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *cond;
+  void *then;
+  void *els;
+  if (list_nth(0, args, &cond) != 0){ return 1; }
+  if (list_nth(1, args, &then) != 0){ return 1; }
+  if (list_nth(2, args, &els) != 0){ return 1; }
+  void *condevaluated;
+  void *conddereferenced;
+  if (micolisp_eval(cond, machine, &condevaluated) != 0){ return 1; }
+  if (micolisp_reference_get(condevaluated, machine, &conddereferenced) != 0){ return 1; }
+  if (micolisp_decrease(conddereferenced, machine) != 0){ return 1; }
+  return micolisp_eval(conddereferenced != NULL? then: els, machine, valuep);
+}
+
+static int __micolisp_while (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args == NULL){ return 1; }
+  void *cond = args->car;
+  void *forms = args->cdr;
+  while (true){
+    void *condevaluated;
+    if (micolisp_eval(cond, machine, &condevaluated) != 0){ return 1; }
+    if (micolisp_decrease(condevaluated, machine) != 0){ return 1; }
+    if (condevaluated != NULL){
+      void *formsevaluated;
+      if (__micolisp_progn(forms, machine, &formsevaluated) != 0){ return 1; }
+      if (micolisp_decrease(formsevaluated, machine) != 0){ return 1; }
+    }
+    else {
+      break;
+    }
+  }
+  *valuep = NULL;
+  return 0;
+}
+
+// a call of a builtin function is evaluated here when the name is bound to a number held by the binding alone,
+// so the arithmetic can write its result into the number which the binding is about to drop.
+// the number is looked up after the arguments, which may rebind the name, and only the outermost call may take it.
+
+static int micolisp_eval_rebinding (void *form, void *name, micolisp_machine *machine, void **valuep){
+  if (!machine->numberreuse || machine->scope == NULL || 
+    !micolisp_typep(MICOLISP_CONS, form, machine) || !listp(form, machine) || 
+    !micolisp_typep(MICOLISP_SYMBOL, ((micolisp_cons*)form)->car, machine)){
+    return micolisp_eval(form, machine, valuep);
+  }
+  void *function;
+  if (micolisp_eval(((micolisp_cons*)form)->car, machine, &function) != 0){ return 1; }
+  if (!micolisp_functionp(function, machine)){
+    micolisp_decrease(function, machine);
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "operator in formula is non function.");
+    return 1;
+  }
+  if (!micolisp_typep(MICOLISP_C_FUNCTION, function, machine) || ((micolisp_function*)function)->type != MICOLISP_FUNCTION){
+    if (micolisp_function_call(((micolisp_cons*)form)->cdr, function, machine, valuep) != 0){ return 1; }
+    return micolisp_decrease(function, machine);
+  }
+  micolisp_cons *newargs;
+  if (eval_args(((micolisp_cons*)form)->cdr, machine, &newargs) != 0){ return 1; }
+  void *found;
+  if (hashtable_get(name, &(machine->scope->hashtable), &found) == 0 && micolisp_memory_typep(MICOLISP_NUMBER, found, &(machine->memory))){
+    machine->resultargs = newargs;
+    machine->resultnumber = found;
+  }
+  int status = micolisp_c_function_call(newargs, function, machine, valuep);
+  machine->resultargs = NULL;
+  machine->resultnumber = NULL;
+  if (micolisp_decrease(newargs, machine) != 0){ return 1; }
+  if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return status;
+}
+
+static int __micolisp_var (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *name;
+  void *form;
+  void *formevaluated;
+  if (list_nth(0, args, &name) != 0){ return 1; }
+  if (list_nth(1, args, &form) != 0){ return 1; }
+  if (micolisp_eval_rebinding(form, name, machine, &formevaluated) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_SYMBOL, name, machine)){ return 1; }
+  if (micolisp_scope_set(formevaluated, name, machine) != 0){ return 1; }
+  *valuep = formevaluated;
+  return 0;
+}
+
+static int __micolisp_set (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *reference;
+  void *form;
+  void *referenceevaluated;
+  void *formevaluated;
+  if (list_nth(0, args, &reference) != 0){ return 1; }
+  if (list_nth(1, args, &form) != 0){ return 1; }
+  if (micolisp_eval(reference, machine, &referenceevaluated) != 0){ return 1; }
+  if (micolisp_eval(form, machine, &formevaluated) != 0){ return 1; }
+  if (!micolisp_referencep(referenceevaluated, machine)){ return 1; }
+  if (micolisp_reference_set(formevaluated, referenceevaluated, machine) != 0){ return 1; }
+  if (micolisp_decrease(referenceevaluated, machine) != 0){ return 1; }
+  *valuep = formevaluated;
+  return 0;
+}
+
+static int __micolisp_quote (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (micolisp_increase(value, machine) != 0){ return 1; }
+  *valuep = value;
+  return 0;
+}
+
+// builtin function
+
+static int __micolisp_symbol (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (!listp(value, machine)){ return 1; }
+  char *buffer = malloc(MAX(1, list_length(value)));
+  if (buffer == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
+  }
+  size_t index;
+  micolisp_cons *cons;
+  for (index = 0, cons = value; cons != NULL; index++, cons = cons->cdr){
+    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ 
+      free(buffer);
+      return 1; 
+    }
+    buffer[index] = (int)*(micolisp_number*)(cons->car);
+  }
+  micolisp_symbol *symbol = micolisp_allocate_symbol(buffer, index, machine);
+  free(buffer);
+  if (symbol == NULL){ return 1; }
+  *valuep = symbol;
+  return 0;
+}
+
+static int __micolisp_symbol_name (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *symbol;
+  if (list_nth(0, args, &symbol) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_SYMBOL, symbol, machine)){ return 1; }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (size_t index = 0; index < ((micolisp_symbol*)symbol)->length; index++){
+    micolisp_number *number = micolisp_allocate_number(machine);
+    if (number == NULL){ 
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+    *number = ((micolisp_symbol*)symbol)->characters[index];
+    if (micolisp_list_builder_push(number, &builder) != 0){ 
+      micolisp_decrease(number, machine);
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+}
+
+static int __micolisp_symbol_value (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *symbol;
+  if (list_nth(0, args, &symbol) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_SYMBOL, symbol, machine)){ return 1; }
+  micolisp_scope_reference *reference = micolisp_scope_get_reference(symbol, machine);
+  if (reference == NULL){ return 1; }
+  *valuep = reference;
+  return 0;
+}
+
+static int __micolisp_cons (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *car;
+  void *cdr;
+  if (list_nth(0, args, &car) != 0){ return 1; }
+  if (list_nth(1, args, &cdr) != 0){ return 1; }
+  micolisp_cons *cons = micolisp_allocate_cons(car, cdr, machine);
+  if (cons == NULL){ return 1; }
+  *valuep = cons;
+  return 0;
+}
+
+static int __micolisp_list (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
+    if (micolisp_increase(cons->car, machine) != 0){ 
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+    if (micolisp_list_builder_push(cons->car, &builder) != 0){ 
+      micolisp_decrease(cons->car, machine);
+      micolisp_list_builder_abort(&builder, machine);
+      return 1; 
+    }
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+}
+
+static int __micolisp_car (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *cons;
+  if (list_nth(0, args, &cons) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_CONS, cons, machine)){ return 1; }
+  micolisp_cons_reference *reference = micolisp_cons_get_reference(MICOLISP_CONS_CAR, cons, machine);
+  if (reference == NULL){ return 1; }
+  *valuep = reference;
+  return 0;
+}
+
+static int __micolisp_cdr (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *cons;
+  if (list_nth(0, args, &cons) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_CONS, cons, machine)){ return 1; }
+  micolisp_cons_reference *reference = micolisp_cons_get_reference(MICOLISP_CONS_CDR, cons, machine);
+  if (reference == NULL){ return 1; }
+  *valuep = reference;
+  return 0;
+}
+
+static bool micolisp_memory_typep (micolisp_memory_type, void*, micolisp_memory*);
+
+// a heap number reached only from the evaluated arguments is a temporary,
+// so the result is written into it instead of a new number.
+// the number which var is about to rebind is held by its binding and these arguments alone, so it is taken too.
+// callers read their arguments before the result is written.
+
+static micolisp_number *micolisp_allocate_result (micolisp_cons *args, micolisp_machine *machine){
+  if (machine->numberreuse && args != NULL && args == machine->resultargs){
+    micolisp_number *number = machine->resultnumber;
+    machine->resultargs = NULL;
+    machine->resultnumber = NULL;
+    if (((micolisp_number_cell*)number)->references == 2){
+      for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
+        if (cons->car == number){
+          if (micolisp_increase(number, machine) != 0){ return NULL; }
+          return number;
+        }
+      }
+    }
+  }
+  if (machine->numberreuse && !micolisp_arenap(args, machine)){
+    for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
+      if (micolisp_memory_typep(MICOLISP_NUMBER, cons->car, &(machine->memory)) && ((micolisp_number_cell*)(cons->car))->references == 1){
+        if (micolisp_increase(cons->car, machine) != 0){ return NULL; }
+        return cons->car;
+      }
+    }
+  }
+  return micolisp_allocate_number(machine);
+}
+
+static int __micolisp_add (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  micolisp_number result = 0;
+  for (micolisp_cons *cons = args; cons != NULL; cons = cons->cdr){
+    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+    result += *(micolisp_number*)(cons->car);
+  }
+  micolisp_number *resultp = micolisp_allocate_result(args, machine);
+  if (resultp == NULL){ return 1; }
+  *resultp = result;
+  *valuep = resultp;
+  return 0;
+}
+
+static int __micolisp_sub (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    micolisp_number result = *(micolisp_number*)(args->car);
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      result -= *(micolisp_number*)(cons->car);
+    }
+    micolisp_number *resultp = micolisp_allocate_result(args, machine);
+    if (resultp == NULL){ return 1; }
+    *resultp = result;
+    *valuep = resultp;
+    return 0;
+  }
+  else {
+    return 1;
+  }
+}
+
+static int __micolisp_mul (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    micolisp_number result = *(micolisp_number*)(args->car);
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      result *= *(micolisp_number*)(cons->car);
+    }
+    micolisp_number *resultp = micolisp_allocate_result(args, machine);
+    if (resultp == NULL){ return 1; }
+    *resultp = result;
+    *valuep = resultp;
+    return 0;
+  }
+  else {
+    return 1;
+  }
+}
+
+static int __micolisp_div (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    micolisp_number result = *(micolisp_number*)(args->car);
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      result /= *(micolisp_number*)(cons->car);
+    }
+    micolisp_number *resultp = micolisp_allocate_result(args, machine);
+    if (resultp == NULL){ return 1; }
+    *resultp = result;
+    *valuep = resultp;
+    return 0;
+  }
+  else {
+    return 1;
+  }
+}
+
+static int __micolisp_mod (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    micolisp_number result = *(micolisp_number*)(args->car);
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      result = result - floor(result / *(micolisp_number*)(cons->car));
+    }
+    micolisp_number *resultp = micolisp_allocate_result(args, machine);
+    if (resultp == NULL){ return 1; }
+    *resultp = result;
+    *valuep = resultp;
+    return 0;
+  }
+  else {
+    return 1;
+  }
+}
+
+static int __micolisp_lshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (intmax_t)integerpart1 << (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_rshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (intmax_t)integerpart1 >> (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_log_rshift (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (uintmax_t)integerpart1 >> (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_log_not (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value, machine)){ return 1; }
+  double integerpart;
+  double decimalpart = modf(*(micolisp_number*)value, &integerpart);
+  if (abs(decimalpart) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = ~(intmax_t)integerpart;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_log_and (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (intmax_t)integerpart1 & (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_log_or (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (intmax_t)integerpart1 | (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_log_xor (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value1;
+  void *value2;
+  if (list_nth(0, args, &value1) != 0){ return 1; }
+  if (list_nth(1, args, &value2) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value1, machine)){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, value2, machine)){ return 1; }
+  double integerpart1;
+  double decimalpart1 = modf(*(micolisp_number*)value1, &integerpart1);
+  double integerpart2;
+  double decimalpart2 = modf(*(micolisp_number*)value2, &integerpart2);
+  if (abs(decimalpart1) <= 0.0 && abs(decimalpart2) <= 0.0){
+    micolisp_number *number = micolisp_allocate_result(args, machine);
+    if (number == NULL){ return 1; }
+    *number = (intmax_t)integerpart1 ^ (intmax_t)integerpart2;
+    *valuep = number;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_floor (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *number;
+  if (list_nth(0, args, &number) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
+  micolisp_number *newnumber = micolisp_allocate_result(args, machine);
+  if (newnumber == NULL){ return 1; }
+  *newnumber = floor(*(micolisp_number*)number);
+  *valuep = newnumber;
+  return 0;
+}
+
+static int __micolisp_ceil (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *number;
+  if (list_nth(0, args, &number) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
+  micolisp_number *newnumber = micolisp_allocate_result(args, machine);
+  if (newnumber == NULL){ return 1; }
+  *newnumber = ceil(*(micolisp_number*)number);
+  *valuep = newnumber;
+  return 0;
+}
+
+static int __micolisp_round (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *number;
+  if (list_nth(0, args, &number) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, number, machine)){ return 1; }
+  micolisp_number *newnumber = micolisp_allocate_result(args, machine);
+  if (newnumber == NULL){ return 1; }
+  *newnumber = round(*(micolisp_number*)number);
+  *valuep = newnumber;
+  return 0;
+}
+
+static bool equal (void*, void*, micolisp_machine*);
+
+static bool equal_cons (micolisp_cons *cons1, micolisp_cons *cons2, micolisp_machine *machine){
+  return equal(cons1->car, cons2->car, machine) && equal(cons1->cdr, cons2->cdr, machine);
+}
+
+static bool equal (void *value1, void *value2, micolisp_machine *machine){
+  if (micolisp_typep(MICOLISP_NUMBER, value1, machine) && micolisp_typep(MICOLISP_NUMBER, value2, machine)){
+    return *(micolisp_number*)value1 == *(micolisp_number*)value2;
+  }
+  else 
+  if (micolisp_typep(MICOLISP_CONS, value1, machine) && micolisp_typep(MICOLISP_CONS, value2, machine)){
+    return equal_cons(value1, value2, machine);
+  }
+  else {
+    return value1 == value2;
+  }
+}
+
+static int __micolisp_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    void *first = args->car;
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!equal(first, cons->car, machine)){
+        *valuep = MICOLISP_NIL;
+        return 0;
+      }
+    }
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_unequal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (__micolisp_equal(args, machine, &value) != 0){ return 1; }
+  *valuep = value != MICOLISP_NIL? MICOLISP_NIL: MICOLISP_T;
+  return 0;
+}
+
+static int __micolisp_less (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      if (!(*(micolisp_number*)(args->car) < *(micolisp_number*)(cons->car))){
+        *valuep = MICOLISP_NIL;
+        return 0;
+      }
+    }
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_less_or_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      if (!(*(micolisp_number*)(args->car) <= *(micolisp_number*)(cons->car))){
+        *valuep = MICOLISP_NIL;
+        return 0;
+      }
+    }
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_great (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      if (!(*(micolisp_number*)(args->car) > *(micolisp_number*)(cons->car))){
+        *valuep = MICOLISP_NIL;
+        return 0;
+      }
+    }
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_great_or_equal (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (args != NULL){
+    if (!micolisp_typep(MICOLISP_NUMBER, args->car, machine)){ return 1; }
+    for (micolisp_cons *cons = args->cdr; cons != NULL; cons = cons->cdr){
+      if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+      if (!(*(micolisp_number*)(args->car) >= *(micolisp_number*)(cons->car))){
+        *valuep = MICOLISP_NIL;
+        return 0;
+      }
+    }
+    *valuep = MICOLISP_T;
+    return 0;
+  }
+  else {
+    return 1; 
+  }
+}
+
+static int __micolisp_numberp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  *valuep = micolisp_typep(MICOLISP_NUMBER, value, machine)? MICOLISP_T: MICOLISP_NIL;
+  return 0;
+}
+
+static int __micolisp_symbolp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  *valuep = micolisp_typep(MICOLISP_SYMBOL, value, machine)? MICOLISP_T: MICOLISP_NIL;
+  return 0;
+}
+
+static int __micolisp_functionp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  *valuep = micolisp_functionp(value, machine)? MICOLISP_T: MICOLISP_NIL;
+  return 0;
+}
+
+static int __micolisp_consp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  *valuep = micolisp_typep(MICOLISP_CONS, value, machine)? MICOLISP_T: MICOLISP_NIL;
+  return 0;
+}
+
+static int __micolisp_listp (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  *valuep = listp(value, machine)? MICOLISP_T: MICOLISP_NIL;
+  return 0;
+}
+
+static int __micolisp_read (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (micolisp_read(stdin, machine, &value) != 0){ return 1; }
+  *valuep = value;
+  return 0;
+}
+
+static int __micolisp_read_string (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  size_t readsize;
+  if (1 <= list_length(args)){
+    void *size;
+    if (list_nth(0, args, &size) != 0){ return 1; }
+    if (!micolisp_typep(MICOLISP_NUMBER, size, machine)){ return 1; }
+    readsize = *(micolisp_number*)size;
+  }
+  else {
+    readsize = SIZE_MAX;
+  }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (size_t index = 0; index < readsize; index++){
+    int character = getc(stdin);
+    if (character != EOF){
+      micolisp_number *number = micolisp_allocate_number(machine);
+      if (number == NULL){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      *number = character;
+      if (micolisp_list_builder_push(number, &builder) != 0){ 
+        micolisp_decrease(number, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+    }
+    else {
+      break;
+    }
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+}
+
+static int __micolisp_read_line (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  size_t readsize;
+  if (1 <= list_length(args)){
+    void *size;
+    if (list_nth(0, args, &size) != 0){ return 1; }
+    if (!micolisp_typep(MICOLISP_NUMBER, size, machine)){ return 1; }
+    readsize = *(micolisp_number*)size;
+  }
+  else {
+    readsize = SIZE_MAX;
+  }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (size_t index = 0; index < readsize; index++){
+    int character = getc(stdin);
+    if (character != EOF){
+      micolisp_number *number = micolisp_allocate_number(machine);
+      if (number == NULL){ 
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      *number = character;
+      if (micolisp_list_builder_push(number, &builder) != 0){ 
+        micolisp_decrease(number, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1; 
+      }
+      if (character == '\n'){
+        break;
+      }
+    }
+    else {
+      break;
+    }
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+}
+
+static int __micolisp_eval (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  void *valueevaluated;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (micolisp_eval(value, machine, &valueevaluated) != 0){ return 1; }
+  *valuep = valueevaluated;
+  return 0;
+}
+
+static int __micolisp_eval_string (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *list;
+  if (list_nth(0, args, &list) != 0){ return 1; }
+  if (!listp(list, machine)){ return 1; }
+  size_t length = list_length(list);
+  char buffer[length];
+  size_t index;
+  micolisp_cons *cons;
+  for (index = 0, cons = list; index < length && cons != NULL; index++, cons = cons->cdr){
+    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+    buffer[index] = *(micolisp_number*)(cons->car);
+  }
+  return micolisp_eval_string(buffer, length, machine, valuep);
+}
+
+static int __micolisp_print (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (micolisp_print(value, stdout, machine) != 0){ return 1; }
+  if (micolisp_increase(value, machine) != 0){ return 1; }
+  *valuep = value;
+  return 0;
+}
+
+static int __micolisp_println (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  if (micolisp_println(value, stdout, machine) != 0){ return 1; }
+  if (micolisp_increase(value, machine) != 0){ return 1; }
+  *valuep = value;
+  return 0;
+}
+
+static int __micolisp_print_to_string (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *value;
+  if (list_nth(0, args, &value) != 0){ return 1; }
+  char *sequence;
+  size_t length;
+  if (micolisp_print_to_buffer(value, machine, &sequence, &length) != 0){ return 1; }
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  int status = 0;
+  for (size_t index = 0; status == 0 && index < length; index++){
+    micolisp_number *number = micolisp_allocate_number(machine);
+    if (number == NULL){ status = 1; break; }
+    *number = sequence[index];
+    status = micolisp_list_builder_push(number, &builder);
+    if (status != 0){ micolisp_decrease(number, machine); }
+  }
+  free(sequence);
+  if (status != 0){
+    micolisp_list_builder_abort(&builder, machine);
+    return 1;
+  }
+  return micolisp_list_builder_finish(NULL, &builder, machine, valuep);
+}
+
+static int __micolisp_write (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *list;
+  if (list_nth(0, args, &list) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_CONS, list, machine)){ return 1; }
+  char sequence[MICOLISP_PRINT_BUFFER_SIZE];
+  micolisp_port port;
+  micolisp_port_init(stdout, sequence, sizeof(sequence), false, &port);
+  for (micolisp_cons *cons = list; cons != NULL; cons = cons->cdr){
+    void *consdereferenced;
+    if (micolisp_reference_get(cons, machine, &consdereferenced) != 0 || 
+        !micolisp_typep(MICOLISP_CONS, consdereferenced, machine) || 
+        !micolisp_typep(MICOLISP_NUMBER, ((micolisp_cons*)consdereferenced)->car, machine) || 
+        micolisp_port_put((char)*(micolisp_number*)((micolisp_cons*)consdereferenced)->car, &port) != 0){ 
+      micolisp_port_close(&port);
+      return 1; 
+    }
+  }
+  return micolisp_port_close(&port);
+}
+
+static int __micolisp_writeln (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  if (__micolisp_write(args, machine, valuep) != 0){ return 1; }
+  putchar('\n');
+  return 0;
+}
+
+static int __micolisp_error (micolisp_cons *args, micolisp_machine *machine, void **valuep){
+  void *errorcode;
+  void *errormessage;
+  if (list_nth(0, args, &errorcode) != 0){ return 1; }
+  if (list_nth(1, args, &errormessage) != 0){ return 1; }
+  if (!micolisp_typep(MICOLISP_NUMBER, errorcode, machine)){ return 1; }
+  if (!listp(errormessage, machine)){ return 1; }
+  char buffer[MICOLISP_ERROR_INFO_MAX_LENGTH];
+  size_t index;
+  micolisp_cons *cons;
+  for (index = 0, cons = errormessage; index < MICOLISP_ERROR_INFO_MAX_LENGTH && cons != NULL; index++, cons = cons->cdr){
+    if (!micolisp_typep(MICOLISP_NUMBER, cons->car, machine)){ return 1; }
+    buffer[index] = *(micolisp_number*)(cons->car);
+  }
+  micolisp_error_set(*(micolisp_number*)errorcode, buffer, index);
+  return 1;
+}
+
+// setup syntax 
+
+static int setup_builtin_syntax (micolisp_machine *machine){
+  // define function 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("function", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_function, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define syntax 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("syntax", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_syntax, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define macro 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("macro", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_macro, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define progn 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("progn", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_progn, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define if 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("if", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_if, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define while
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("while", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_while, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define set
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("set", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_set, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define var
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("var", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_var, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define quote
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("quote", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_quote, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  return 0;
+}
+
+// setup function 
+
+static int setup_builtin_function (micolisp_machine *machine){
+  // define symbol 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define symbol-name 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol-name", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol_name, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define symbol-value
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol-value", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol_value, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define cons
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("cons", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_cons, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define list
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("list", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_list, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define car
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("car", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_car, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define cdr
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("cdr", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_cdr, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define + 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("+", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_add, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define -
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("-", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_sub, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define *
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("*", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_mul, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define / 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("/", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_div, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define % 
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("%", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_mod, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define <<
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("<<", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_lshift, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define >>
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0(">>", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_rshift, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define >>>
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0(">>>", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_rshift, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define ~
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("~", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_not, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define &
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("&", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_and, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define |
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("|", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_or, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define ^
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("^", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_xor, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define floor
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("floor", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_floor, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define ceil
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("ceil", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_ceil, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define round
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("round", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_round, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define ==
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("==", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_equal, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define !=
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("!=", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_unequal, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define <
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("<", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_less, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define <=
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("<=", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_less_or_equal, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define >
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0(">", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_great, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define >=
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0(">=", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_great_or_equal, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define numberp
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("numberp", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_numberp, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define symbolp
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbolp", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbolp, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define functionp
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("functionp", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_functionp, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define consp
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("consp", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_consp, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define listp
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("listp", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_listp, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define read
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("read", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define read-string
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("read-string", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read_string, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(function, machine) != 0){ return 1; }
   }
-  // define if 
+  // define read-line
   {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("if", machine);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("read-line", machine);
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_if, machine);
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read_line, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(function, machine) != 0){ return 1; }
   }
-  // define while
+  // define eval
   {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("while", machine);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("eval", machine);
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_while, machine);
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_eval, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(function, machine) != 0){ return 1; }
   }
-  // define set
+  // define eval-string
   {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("set", machine);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("eval-string", machine);
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_set, machine);
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_eval_string, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(function, machine) != 0){ return 1; }
   }
-  // define var
+  // define print
   {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("var", machine);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("print", machine);
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_var, machine);
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_print, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(function, machine) != 0){ return 1; }
   }
-  // define quote
+  // define println
   {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("quote", machine);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("println", machine);
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_SYNTAX, __micolisp_quote, machine);
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_println, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define print-to-string
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("print-to-string", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_print_to_string, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define write
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("write", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_write, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define writeln
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("writeln", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_writeln, machine);
+    if (function == NULL){ return 1; }
+    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
+    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  }
+  // define error
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("error", machine);
+    if (symbol == NULL){ return 1; }
+    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_error, machine);
     if (function == NULL){ return 1; }
     if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
     if (micolisp_decrease(symbol, machine) != 0){ return 1; }
@@ -2380,553 +5707,1603 @@ static int setup_builtin_syntax (micolisp_machine *machine){
   return 0;
 }
 
-// setup function 
+// setup lisp function 
+
+static int setup_builtin_lisp_function (micolisp_machine *machine){
+  // define not 
+  {
+    char source[] = "(function not (any) (if any nil t))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define null 
+  {
+    char source[] = "(var null not)";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define length
+  {
+    char source[] = "(function length (lst) (if (null lst) 0 (+ (length (cdr lst)) 1)))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define nth
+  {
+    char source[] = "(function nth (index lst) (if (null lst) nil (if (<= index 0) (car lst) (nth (- index 1) (cdr lst)))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define map
+  {
+    char source[] = "(function map (fn lst) (if (null lst) nil (cons (fn (car lst)) (map fn (cdr lst)))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define filter
+  {
+    char source[] = "(function filter (fn lst) (if (null lst) nil (if (fn (car lst)) (cons (car lst) (filter fn (cdr lst))) (filter fn (cdr lst)))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define --reduce
+  {
+    char source[] = "(function --reduce (fn acc lst) (if (null lst) acc (--reduce fn (fn acc (car lst)) (cdr lst))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define reduce
+  {
+    char source[] = "(function reduce (fn lst) (if (null lst) nil (--reduce fn (car lst) (cdr lst))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define find
+  {
+    char source[] = "(function find (fn lst) (if (null lst) nil (if (fn (car lst)) (car lst) (find fn (cdr lst)))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  return 0;
+}
+
+// setup macro 
+
+static int setup_builtin_macro (micolisp_machine *machine){
+  // define until 
+  {
+    char source[] = "(macro until (cond &rest forms) (cons 'while (cons (list 'not cond) forms)))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define when
+  {
+    char source[] = "(macro when (cond &rest forms) (list 'if cond (cons 'progn forms) nil))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define unless 
+  {
+    char source[] = "(macro unless (cond &rest forms) (list 'if cond nil (cons 'progn forms)))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define and 
+  {
+    char source[] = "(macro and (&rest forms) (if (null forms) t (if (null (cdr forms)) (car forms) (list 'if (car forms) (cons 'and (cdr forms)) nil))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define or 
+  {
+    char source[] = "(macro or (&rest forms) (if (null forms) nil (list 'progn (list 'var '--temp (car forms)) (list 'if '--temp '--temp (cons 'or (cdr forms))))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  // define cond 
+  {
+    char source[] = "(macro cond (&rest conds) (if (null conds) nil (list 'if (car (car conds)) (cons 'progn (cdr (car conds))) (cons 'cond (cdr conds)))))";
+    void *value;
+    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
+    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  }
+  return 0;
+}
+
+// image 
+
+#define MICOLISP_IMAGE_MAGIC "micolisp-image\n"
+#define MICOLISP_IMAGE_MAGIC_LENGTH 15
+#define MICOLISP_IMAGE_VERSION 1
+
+typedef enum micolisp_image_tag {
+  MICOLISP_IMAGE_NIL,
+  MICOLISP_IMAGE_T,
+  MICOLISP_IMAGE_NUMBER,
+  MICOLISP_IMAGE_SYMBOL,
+  MICOLISP_IMAGE_LIST,
+  MICOLISP_IMAGE_C_FUNCTION,
+  MICOLISP_IMAGE_USER_FUNCTION,
+  MICOLISP_IMAGE_SHARED,
+} micolisp_image_tag;
+
+typedef struct micolisp_image_writer {
+  FILE *file;
+  hashtable written; // address -> index + 1, or NULL while it is being written.
+  size_t count;
+  hashtable builtin; // c-function main -> symbol 
+} micolisp_image_writer;
+
+typedef struct micolisp_image_reader {
+  FILE *file;
+  void **objects;
+  size_t length;
+  size_t capacity;
+} micolisp_image_reader;
+
+static int setup_builtin_syntax (micolisp_machine*);
+static int setup_builtin_function (micolisp_machine*);
+
+static int micolisp_image_write (void *data, size_t size, FILE *file){
+  if (fwrite(data, 1, size, file) != size){
+    micolisp_error_set0(MICOLISP_ERROR, "could not write the image.");
+    return 1;
+  }
+  return 0;
+}
+
+static int micolisp_image_write_tag (micolisp_image_tag tag, FILE *file){
+  uint8_t byte = tag;
+  return micolisp_image_write(&byte, sizeof(byte), file);
+}
+
+static int micolisp_image_write_size (size_t size, FILE *file){
+  uint64_t size64 = size;
+  return micolisp_image_write(&size64, sizeof(size64), file);
+}
+
+static int micolisp_image_write_symbol (micolisp_symbol *symbol, FILE *file){
+  if (micolisp_image_write_size(symbol->length, file) != 0){ return 1; }
+  return micolisp_image_write(symbol->characters, symbol->length, file);
+}
+
+static int micolisp_image_written (void *address, micolisp_image_writer *writer){
+  writer->count += 1;
+  return address_table_set((void*)(uintptr_t)writer->count, address, &(writer->written));
+}
+
+// lists are written as their cars and the last cdr, 
+// so long lists does not deepen the recursion.
+
+static int micolisp_image_write_object (void *value, micolisp_image_writer *writer, micolisp_machine *machine){
+  if (value == MICOLISP_NIL){
+    return micolisp_image_write_tag(MICOLISP_IMAGE_NIL, writer->file);
+  }
+  if (value == MICOLISP_T){
+    return micolisp_image_write_tag(MICOLISP_IMAGE_T, writer->file);
+  }
+  void *found;
+  if (hashtable_get(value, &(writer->written), &found) == 0){
+    if (found == NULL){
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "circular object could not be saved to the image.");
+      return 1;
+    }
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_SHARED, writer->file) != 0){ return 1; }
+    return micolisp_image_write_size((uintptr_t)found - 1, writer->file);
+  }
+  if (micolisp_typep(MICOLISP_NUMBER, value, machine)){
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_NUMBER, writer->file) != 0){ return 1; }
+    return micolisp_image_write(value, sizeof(micolisp_number), writer->file);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, value, machine)){
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_SYMBOL, writer->file) != 0){ return 1; }
+    return micolisp_image_write_symbol(value, writer->file);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_C_FUNCTION, value, machine)){
+    micolisp_c_function *function = value;
+    void *name;
+    if (hashtable_get((void*)function->main, &(writer->builtin), &name) != 0){
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "c-function which is not builtin could not be saved to the image.");
+      return 1;
+    }
+    uint8_t type = function->function.type;
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_C_FUNCTION, writer->file) != 0){ return 1; }
+    if (micolisp_image_write(&type, sizeof(type), writer->file) != 0){ return 1; }
+    return micolisp_image_write_symbol(name, writer->file);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_USER_FUNCTION, value, machine)){
+    micolisp_user_function *function = value;
+    uint8_t type = function->function.type;
+    if (address_table_set(NULL, value, &(writer->written)) != 0){ return 1; }
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_USER_FUNCTION, writer->file) != 0){ return 1; }
+    if (micolisp_image_write(&type, sizeof(type), writer->file) != 0){ return 1; }
+    if (micolisp_image_write_object(function->args, writer, machine) != 0){ return 1; }
+    if (micolisp_image_write_object(function->form, writer, machine) != 0){ return 1; }
+    return micolisp_image_written(value, writer);
+  }
+  else 
+  if (micolisp_typep(MICOLISP_CONS, value, machine)){
+    size_t length = 0;
+    micolisp_cons *last = value;
+    while (true){
+      if (address_table_set(NULL, last, &(writer->written)) != 0){ return 1; }
+      length += 1;
+      if (!micolisp_typep(MICOLISP_CONS, last->cdr, machine)){ break; }
+      if (hashtable_get(last->cdr, &(writer->written), &found) == 0){ break; }
+      last = last->cdr;
+    }
+    if (micolisp_image_write_tag(MICOLISP_IMAGE_LIST, writer->file) != 0){ return 1; }
+    if (micolisp_image_write_size(length, writer->file) != 0){ return 1; }
+    micolisp_cons *cons = value;
+    for (size_t index = 0; index < length; index++, cons = cons->cdr){
+      if (micolisp_image_write_object(cons->car, writer, machine) != 0){ return 1; }
+    }
+    if (micolisp_image_write_object(last->cdr, writer, machine) != 0){ return 1; }
+    cons = value;
+    for (size_t index = 0; index < length; index++, cons = cons->cdr){
+      if (micolisp_image_written(cons, writer) != 0){ return 1; }
+    }
+    return 0;
+  }
+  else {
+    micolisp_error_set0(MICOLISP_TYPE_ERROR, "given value could not be saved to the image.");
+    return 1;
+  }
+}
+
+static int micolisp_image_writer_init (FILE *file, micolisp_machine *builtin, micolisp_image_writer *writer){
+  writer->file = file;
+  writer->count = 0;
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer->written));
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer->builtin));
+  hashtable_iterator iterator = hashtable_iterate(&(builtin->scope->hashtable));
+  hashtable_entry entry;
+  while (hashtable_iterator_next(&iterator, &(builtin->scope->hashtable), &entry) == 0){
+    if (micolisp_typep(MICOLISP_C_FUNCTION, entry.value, builtin)){
+      if (address_table_set(entry.key, (void*)((micolisp_c_function*)entry.value)->main, &(writer->builtin)) != 0){ return 1; }
+    }
+  }
+  return 0;
+}
+
+static void micolisp_image_writer_free (micolisp_image_writer *writer){
+  free(writer->written.entries);
+  free(writer->builtin.entries);
+}
+
+int micolisp_save_image (FILE *file, micolisp_machine *machine){
+  micolisp_scope *root = micolisp_scope_root(machine);
+  if (root == NULL){
+    micolisp_error_set0(MICOLISP_ERROR, "no savable scope, because scope is nil.");
+    return 1;
+  }
+  // c-functions are saved by their builtin names.
+  micolisp_machine builtin;
+  if (micolisp_open(&builtin) != 0){ return 1; }
+  if (setup_builtin_syntax(&builtin) != 0 || setup_builtin_function(&builtin) != 0){
+    micolisp_close(&builtin);
+    return 1;
+  }
+  micolisp_image_writer writer;
+  int status = micolisp_image_writer_init(file, &builtin, &writer);
+  if (status == 0){ status = micolisp_image_write(MICOLISP_IMAGE_MAGIC, MICOLISP_IMAGE_MAGIC_LENGTH, file); }
+  if (status == 0){ status = micolisp_image_write_size(MICOLISP_IMAGE_VERSION, file); }
+  if (status == 0){
+    hashtable_iterator iterator = hashtable_iterate(&(root->hashtable));
+    hashtable_entry entry;
+    while (status == 0 && hashtable_iterator_next(&iterator, &(root->hashtable), &entry) == 0){
+      status = micolisp_image_write_object(entry.key, &writer, machine);
+      if (status == 0){ status = micolisp_image_write_object(entry.value, &writer, machine); }
+    }
+  }
+  if (status == 0){ status = micolisp_image_write_tag(MICOLISP_IMAGE_NIL, file); }
+  micolisp_image_writer_free(&writer);
+  if (micolisp_close(&builtin) != 0){ return 1; }
+  return status;
+}
+
+static int micolisp_image_read (void *data, size_t size, FILE *file){
+  if (fread(data, 1, size, file) != size){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the image, because it was broken.");
+    return 1;
+  }
+  return 0;
+}
+
+static int micolisp_image_read_size (FILE *file, size_t *sizep){
+  uint64_t size64;
+  if (micolisp_image_read(&size64, sizeof(size64), file) != 0){ return 1; }
+  *sizep = size64;
+  return 0;
+}
+
+static int micolisp_image_read_symbol (FILE *file, micolisp_machine *machine, void **valuep){
+  size_t length;
+  if (micolisp_image_read_size(file, &length) != 0){ return 1; }
+  char *buffer = malloc(MAX(1, length));
+  if (buffer == NULL){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
+  }
+  if (micolisp_image_read(buffer, length, file) != 0){ 
+    free(buffer);
+    return 1; 
+  }
+  micolisp_symbol *symbol = micolisp_allocate_symbol(buffer, length, machine);
+  free(buffer);
+  if (symbol == NULL){ return 1; }
+  *valuep = symbol;
+  return 0;
+}
+
+// objects are remembered without counting, 
+// they are kept alive by the values which are being read.
 
-static int setup_builtin_function (micolisp_machine *machine){
-  // define symbol 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
-  }
-  // define symbol-name 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol-name", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol_name, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+static int micolisp_image_reader_push (void *value, micolisp_image_reader *reader){
+  if (reader->capacity <= reader->length){
+    size_t newcapacity = MAX(64, reader->capacity * 2);
+    void **newobjects = realloc(reader->objects, newcapacity * sizeof(void*));
+    if (newobjects == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    reader->objects = newobjects;
+    reader->capacity = newcapacity;
   }
-  // define symbol-value
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbol-value", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbol_value, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  reader->objects[reader->length] = value;
+  reader->length += 1;
+  return 0;
+}
+
+static int micolisp_image_read_object (micolisp_image_reader *reader, micolisp_machine *machine, void **valuep){
+  uint8_t tag;
+  if (micolisp_image_read(&tag, sizeof(tag), reader->file) != 0){ return 1; }
+  switch (tag){
+  case MICOLISP_IMAGE_NIL:
+    *valuep = MICOLISP_NIL;
+    return 0;
+  case MICOLISP_IMAGE_T:
+    *valuep = MICOLISP_T;
+    return 0;
+  case MICOLISP_IMAGE_NUMBER: {
+    micolisp_number *number = micolisp_allocate_number(machine);
+    if (number == NULL){ return 1; }
+    if (micolisp_image_read(number, sizeof(micolisp_number), reader->file) != 0){
+      micolisp_decrease(number, machine);
+      return 1;
+    }
+    *valuep = number;
+    return 0;
   }
-  // define cons
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("cons", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_cons, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  case MICOLISP_IMAGE_SYMBOL:
+    return micolisp_image_read_symbol(reader->file, machine, valuep);
+  case MICOLISP_IMAGE_C_FUNCTION: {
+    uint8_t type;
+    void *name;
+    void *function;
+    if (micolisp_image_read(&type, sizeof(type), reader->file) != 0){ return 1; }
+    if (micolisp_image_read_symbol(reader->file, machine, &name) != 0){ return 1; }
+    int status = micolisp_scope_get(name, machine, &function);
+    if (micolisp_decrease(name, machine) != 0){ return 1; }
+    if (status != 0){ return 1; }
+    if (!micolisp_typep(MICOLISP_C_FUNCTION, function, machine) || ((micolisp_c_function*)function)->function.type != type){
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the image, because builtin c-function was not found.");
+      return 1;
+    }
+    if (micolisp_increase(function, machine) != 0){ return 1; }
+    *valuep = function;
+    return 0;
   }
-  // define list
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("list", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_list, machine);
+  case MICOLISP_IMAGE_USER_FUNCTION: {
+    uint8_t type;
+    void *args;
+    void *form;
+    if (micolisp_image_read(&type, sizeof(type), reader->file) != 0){ return 1; }
+    if (micolisp_image_read_object(reader, machine, &args) != 0){ return 1; }
+    if (micolisp_image_read_object(reader, machine, &form) != 0){
+      micolisp_decrease(args, machine);
+      return 1;
+    }
+    micolisp_user_function *function = micolisp_allocate_user_function(type, args, form, machine);
+    if (micolisp_decrease(args, machine) != 0){ return 1; }
+    if (micolisp_decrease(form, machine) != 0){ return 1; }
     if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+    if (micolisp_image_reader_push(function, reader) != 0){ return 1; }
+    *valuep = function;
+    return 0;
   }
-  // define car
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("car", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_car, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  case MICOLISP_IMAGE_LIST: {
+    size_t length;
+    if (micolisp_image_read_size(reader->file, &length) != 0){ return 1; }
+    micolisp_list_builder builder;
+    micolisp_list_builder_init(&builder);
+    for (size_t index = 0; index < length; index++){
+      void *car;
+      if (micolisp_image_read_object(reader, machine, &car) != 0){
+        micolisp_list_builder_abort(&builder, machine);
+        return 1;
+      }
+      if (micolisp_list_builder_push(car, &builder) != 0){
+        micolisp_decrease(car, machine);
+        micolisp_list_builder_abort(&builder, machine);
+        return 1;
+      }
+    }
+    void *tail;
+    if (micolisp_image_read_object(reader, machine, &tail) != 0){
+      micolisp_list_builder_abort(&builder, machine);
+      return 1;
+    }
+    void *list;
+    if (micolisp_list_builder_finish(tail, &builder, machine, &list) != 0){ return 1; }
+    // the conses are numbered from the first as same as the writer.
+    micolisp_cons *cons = list;
+    for (size_t index = 0; index < length; index++, cons = cons->cdr){
+      if (micolisp_image_reader_push(cons, reader) != 0){
+        micolisp_decrease(list, machine);
+        return 1;
+      }
+    }
+    *valuep = list;
+    return 0;
   }
-  // define cdr
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("cdr", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_cdr, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  case MICOLISP_IMAGE_SHARED: {
+    size_t index;
+    if (micolisp_image_read_size(reader->file, &index) != 0){ return 1; }
+    if (reader->length <= index){
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the image, because it was broken.");
+      return 1;
+    }
+    if (micolisp_increase(reader->objects[index], machine) != 0){ return 1; }
+    *valuep = reader->objects[index];
+    return 0;
   }
-  // define + 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("+", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_add, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  default:
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the image, because it was broken.");
+    return 1;
   }
-  // define -
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("-", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_sub, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+}
+
+// bindings are read at first, and then they are set to the scope,
+// so c-functions are looked up before they are overwritten.
+// names and values are pushed by turns to the builder, which is aborted to release them.
+
+static int micolisp_image_read_bindings (micolisp_image_reader *reader, micolisp_machine *machine, micolisp_list_builder *bindings){
+  while (true){
+    void *name;
+    void *value;
+    if (micolisp_image_read_object(reader, machine, &name) != 0){ return 1; }
+    if (name == MICOLISP_NIL){ return 0; }
+    if (micolisp_list_builder_push(name, bindings) != 0){
+      micolisp_decrease(name, machine);
+      return 1;
+    }
+    if (micolisp_image_read_object(reader, machine, &value) != 0){ return 1; }
+    if (micolisp_list_builder_push(value, bindings) != 0){
+      micolisp_decrease(value, machine);
+      return 1;
+    }
   }
-  // define *
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("*", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_mul, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+}
+
+int micolisp_load_image (FILE *file, micolisp_machine *machine){
+  char magic[MICOLISP_IMAGE_MAGIC_LENGTH];
+  size_t version;
+  if (micolisp_image_read(magic, MICOLISP_IMAGE_MAGIC_LENGTH, file) != 0){ return 1; }
+  if (micolisp_image_read_size(file, &version) != 0){ return 1; }
+  bool imagep = version == MICOLISP_IMAGE_VERSION;
+  for (size_t index = 0; index < MICOLISP_IMAGE_MAGIC_LENGTH; index++){
+    imagep = imagep && magic[index] == MICOLISP_IMAGE_MAGIC[index];
   }
-  // define / 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("/", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_div, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  if (!imagep){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was not a micolisp image.");
+    return 1;
   }
-  // define % 
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("%", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_mod, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  if (setup_builtin_syntax(machine) != 0){ return 1; }
+  if (setup_builtin_function(machine) != 0){ return 1; }
+  micolisp_image_reader reader = { file, NULL, 0, 0 };
+  micolisp_list_builder bindings;
+  micolisp_list_builder_init(&bindings);
+  int status = micolisp_image_read_bindings(&reader, machine, &bindings);
+  free(reader.objects);
+  for (size_t index = 0; status == 0 && index + 1 < bindings.length; index += 2){
+    status = micolisp_scope_set(bindings.values[index +1], bindings.values[index], machine);
+  }
+  if (micolisp_list_builder_abort(&bindings, machine) != 0){ return 1; }
+  return status;
+}
+
+// binary 
+
+// a binary is the magic, the version, the symbol table and the values in post order.
+// lists are written as their cars, their last cdr, and the tag with the number of conses.
+// the reader keeps the values on a stack, so neither the writer nor the reader recurses.
+
+#define MICOLISP_BINARY_MAGIC "micolisp-fasl\n"
+#define MICOLISP_BINARY_MAGIC_LENGTH 14
+#define MICOLISP_BINARY_VERSION 1
+#define MICOLISP_BINARY_INTEGER_MAX 9007199254740992.0
+
+typedef enum micolisp_binary_tag {
+  MICOLISP_BINARY_NIL,
+  MICOLISP_BINARY_T,
+  MICOLISP_BINARY_INTEGER, // zigzag varint.
+  MICOLISP_BINARY_NUMBER, // ieee double in little endian.
+  MICOLISP_BINARY_SYMBOL, // varint index in the symbol table.
+  MICOLISP_BINARY_LIST, // varint number of conses.
+  MICOLISP_BINARY_SHARED, // varint index of conses.
+  MICOLISP_BINARY_END,
+} micolisp_binary_tag;
+
+typedef struct micolisp_binary_stack {
+  void **values;
+  size_t length;
+  size_t capacity;
+} micolisp_binary_stack;
+
+typedef struct micolisp_binary_writer {
+  micolisp_port port;
+  hashtable symbols; // symbol -> index + 1.
+  hashtable references; // cons -> number of references.
+  hashtable written; // cons -> index + 1, or NULL while it is being written.
+  size_t count;
+  micolisp_binary_stack stack;
+} micolisp_binary_writer;
+
+typedef struct micolisp_binary_reader {
+  FILE *file;
+  micolisp_binary_stack symbols;
+  micolisp_binary_stack conses; // conses are remembered without counting.
+  micolisp_binary_stack stack;
+} micolisp_binary_reader;
+
+static int micolisp_binary_stack_push (void *value, micolisp_binary_stack *stack){
+  if (stack->capacity <= stack->length){
+    size_t newcapacity = MAX(64, stack->capacity * 2);
+    void **newvalues = realloc(stack->values, newcapacity * sizeof(void*));
+    if (newvalues == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    stack->values = newvalues;
+    stack->capacity = newcapacity;
   }
-  // define <<
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("<<", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_lshift, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  stack->values[stack->length] = value;
+  stack->length += 1;
+  return 0;
+}
+
+static int micolisp_binary_write_varint (uint64_t integer, micolisp_port *port){
+  char buffer[10];
+  size_t length = 0;
+  while (0x80 <= integer){
+    buffer[length++] = (char)(integer | 0x80);
+    integer >>= 7;
   }
-  // define >>
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0(">>", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_rshift, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  buffer[length++] = (char)integer;
+  return micolisp_port_write(buffer, length, port);
+}
+
+static int micolisp_binary_write_tag (micolisp_binary_tag tag, uint64_t integer, micolisp_port *port){
+  if (micolisp_port_put(tag, port) != 0){ return 1; }
+  return micolisp_binary_write_varint(integer, port);
+}
+
+static int micolisp_binary_write_number (micolisp_number number, micolisp_port *port){
+  double integral;
+  if (modf(number, &integral) == 0.0 && fabs(number) < MICOLISP_BINARY_INTEGER_MAX && !(number == 0.0 && signbit(number))){
+    int64_t integer = (int64_t)number;
+    return micolisp_binary_write_tag(MICOLISP_BINARY_INTEGER, ((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63), port);
   }
-  // define >>>
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0(">>>", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_rshift, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  uint64_t bits;
+  copy((char*)&number, sizeof(bits), (char*)&bits);
+  char buffer[1 + sizeof(bits)];
+  buffer[0] = MICOLISP_BINARY_NUMBER;
+  for (size_t index = 0; index < sizeof(bits); index++){ buffer[1 + index] = (char)(bits >> (index * 8)); }
+  return micolisp_port_write(buffer, sizeof(buffer), port);
+}
+
+// symbols are collected for the table, and references to conses are counted before the values are written.
+
+static int micolisp_binary_collect (void *value, micolisp_binary_writer *writer, micolisp_machine *machine){
+  writer->stack.length = 0;
+  if (micolisp_binary_stack_push(value, &(writer->stack)) != 0){ return 1; }
+  while (0 < writer->stack.length){
+    void *current = writer->stack.values[--writer->stack.length];
+    void *found;
+    if (micolisp_typep(MICOLISP_CONS, current, machine)){
+      if (hashtable_get(current, &(writer->references), &found) == 0){
+        if (address_table_set((void*)((uintptr_t)found +1), current, &(writer->references)) != 0){ return 1; }
+        continue;
+      }
+      if (address_table_set((void*)(uintptr_t)1, current, &(writer->references)) != 0){ return 1; }
+      if (micolisp_binary_stack_push(((micolisp_cons*)current)->cdr, &(writer->stack)) != 0){ return 1; }
+      if (micolisp_binary_stack_push(((micolisp_cons*)current)->car, &(writer->stack)) != 0){ return 1; }
+    }
+    else 
+    if (micolisp_typep(MICOLISP_SYMBOL, current, machine)){
+      if (hashtable_get(current, &(writer->symbols), &found) == 0){ continue; }
+      micolisp_symbol *symbol = current;
+      writer->count += 1;
+      if (address_table_set((void*)(uintptr_t)writer->count, symbol, &(writer->symbols)) != 0){ return 1; }
+      if (micolisp_binary_write_varint(symbol->length, &(writer->port)) != 0){ return 1; }
+      if (micolisp_port_write(symbol->characters, symbol->length, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if (current != MICOLISP_NIL && current != MICOLISP_T && !micolisp_typep(MICOLISP_NUMBER, current, machine)){
+      micolisp_error_set0(MICOLISP_TYPE_ERROR, "given value could not be written as binary.");
+      return 1;
+    }
   }
-  // define ~
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("~", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_not, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return 0;
+}
+
+// the stack holds values to be written, and lists to be closed which are marked by their lowest bit except t.
+
+#define MICOLISP_BINARY_CLOSING ((uintptr_t)1)
+
+static int micolisp_binary_write_values (void *value, micolisp_binary_writer *writer, micolisp_machine *machine){
+  writer->stack.length = 0;
+  if (micolisp_binary_stack_push(value, &(writer->stack)) != 0){ return 1; }
+  while (0 < writer->stack.length){
+    void *current = writer->stack.values[--writer->stack.length];
+    void *found;
+    if (current == MICOLISP_T){
+      if (micolisp_port_put(MICOLISP_BINARY_T, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if ((uintptr_t)current & MICOLISP_BINARY_CLOSING){
+      // the conses are numbered from the first as same as the reader.
+      micolisp_cons *cons = (micolisp_cons*)((uintptr_t)current & ~MICOLISP_BINARY_CLOSING);
+      size_t length = (uintptr_t)writer->stack.values[--writer->stack.length];
+      for (size_t index = 0; index < length; index++, cons = cons->cdr){
+        writer->count += 1;
+        if (address_table_set((void*)(uintptr_t)writer->count, cons, &(writer->written)) != 0){ return 1; }
+      }
+      if (micolisp_binary_write_tag(MICOLISP_BINARY_LIST, length, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if (current == MICOLISP_NIL){
+      if (micolisp_port_put(MICOLISP_BINARY_NIL, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if (micolisp_typep(MICOLISP_NUMBER, current, machine)){
+      if (micolisp_binary_write_number(*(micolisp_number*)current, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if (micolisp_typep(MICOLISP_SYMBOL, current, machine)){
+      hashtable_get(current, &(writer->symbols), &found);
+      if (micolisp_binary_write_tag(MICOLISP_BINARY_SYMBOL, (uintptr_t)found -1, &(writer->port)) != 0){ return 1; }
+    }
+    else 
+    if (hashtable_get(current, &(writer->written), &found) == 0){
+      if (found == NULL){
+        micolisp_error_set0(MICOLISP_VALUE_ERROR, "circular object could not be written as binary.");
+        return 1;
+      }
+      if (micolisp_binary_write_tag(MICOLISP_BINARY_SHARED, (uintptr_t)found -1, &(writer->port)) != 0){ return 1; }
+    }
+    else {
+      // a run of conses until a shared one is a list, so that no car refers into the run.
+      size_t length = 0;
+      micolisp_cons *last = current;
+      while (true){
+        if (address_table_set(NULL, last, &(writer->written)) != 0){ return 1; }
+        length += 1;
+        if (!micolisp_typep(MICOLISP_CONS, last->cdr, machine)){ break; }
+        if (hashtable_get(last->cdr, &(writer->written), &found) == 0){ break; }
+        if (hashtable_get(last->cdr, &(writer->references), &found) == 0 && (uintptr_t)found != 1){ break; }
+        last = last->cdr;
+      }
+      if (micolisp_binary_stack_push((void*)(uintptr_t)length, &(writer->stack)) != 0){ return 1; }
+      if (micolisp_binary_stack_push((void*)((uintptr_t)current | MICOLISP_BINARY_CLOSING), &(writer->stack)) != 0){ return 1; }
+      if (micolisp_binary_stack_push(last->cdr, &(writer->stack)) != 0){ return 1; }
+      size_t base = writer->stack.length;
+      for (size_t index = 0; index < length; index++){
+        if (micolisp_binary_stack_push(NULL, &(writer->stack)) != 0){ return 1; }
+      }
+      micolisp_cons *cons = current;
+      for (size_t index = length; 0 < index; index--, cons = cons->cdr){
+        writer->stack.values[base + index -1] = cons->car;
+      }
+    }
   }
-  // define &
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("&", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_and, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return 0;
+}
+
+int micolisp_write_binary (void *value, FILE *file, micolisp_machine *machine){
+  void *valuedereferenced;
+  if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ return 1; }
+  micolisp_binary_writer writer = { .count = 0, .stack = { NULL, 0, 0 } };
+  if (micolisp_port_open_file(file, &(writer.port)) != 0){ return 1; }
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer.symbols));
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer.references));
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer.written));
+  // the symbol table is counted at first, and then written.
+  micolisp_port counter;
+  micolisp_port_open_buffer(&counter);
+  micolisp_port port = writer.port;
+  writer.port = counter;
+  int status = micolisp_binary_collect(valuedereferenced, &writer, machine);
+  counter = writer.port;
+  writer.port = port;
+  if (status == 0){ status = micolisp_port_write(MICOLISP_BINARY_MAGIC, MICOLISP_BINARY_MAGIC_LENGTH, &(writer.port)); }
+  if (status == 0){ status = micolisp_binary_write_varint(MICOLISP_BINARY_VERSION, &(writer.port)); }
+  if (status == 0){ status = micolisp_binary_write_varint(writer.count, &(writer.port)); }
+  if (status == 0){ status = micolisp_port_write(counter.sequence, counter.length, &(writer.port)); }
+  micolisp_port_close(&counter);
+  writer.count = 0;
+  if (status == 0){ status = micolisp_binary_write_values(valuedereferenced, &writer, machine); }
+  if (status == 0){ status = micolisp_port_put(MICOLISP_BINARY_END, &(writer.port)); }
+  if (micolisp_port_close(&(writer.port)) != 0){ status = 1; }
+  free(writer.symbols.entries);
+  free(writer.references.entries);
+  free(writer.written.entries);
+  free(writer.stack.values);
+  return status;
+}
+
+static int micolisp_binary_broken (){
+  micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the binary, because it was broken.");
+  return 1;
+}
+
+static int micolisp_binary_read_varint (FILE *file, uint64_t *integerp){
+  uint64_t integer = 0;
+  for (int shift = 0; shift < 64; shift += 7){
+    int character = getc_unlocked(file);
+    if (character == EOF){ return micolisp_binary_broken(); }
+    integer |= (uint64_t)(character & 0x7f) << shift;
+    if ((character & 0x80) == 0){
+      *integerp = integer;
+      return 0;
+    }
   }
-  // define |
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("|", machine);
+  return micolisp_binary_broken();
+}
+
+static int micolisp_binary_read_symbols (micolisp_binary_reader *reader, micolisp_machine *machine){
+  uint64_t length;
+  if (micolisp_binary_read_varint(reader->file, &length) != 0){ return 1; }
+  char stackbuffer[128];
+  for (uint64_t index = 0; index < length; index++){
+    uint64_t size;
+    if (micolisp_binary_read_varint(reader->file, &size) != 0){ return 1; }
+    char *buffer = size <= sizeof(stackbuffer)? stackbuffer: malloc(size);
+    if (buffer == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+      return 1;
+    }
+    bool readp = fread(buffer, 1, size, reader->file) == size;
+    micolisp_symbol *symbol = readp? micolisp_allocate_symbol(buffer, size, machine): NULL;
+    if (buffer != stackbuffer){ free(buffer); }
+    if (!readp){ return micolisp_binary_broken(); }
     if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_or, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+    if (micolisp_binary_stack_push(symbol, &(reader->symbols)) != 0){
+      micolisp_decrease(symbol, machine);
+      return 1;
+    }
   }
-  // define ^
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("^", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_log_xor, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return 0;
+}
+
+static int micolisp_binary_read_list (uint64_t length, micolisp_binary_reader *reader, micolisp_machine *machine){
+  micolisp_binary_stack *stack = &(reader->stack);
+  // the length is read from the file, so it is compared without arithmetic which may overflow.
+  if (length == 0 || stack->length <= length){ return micolisp_binary_broken(); }
+  // the counts of the cars and the tail are handed over to the list.
+  stack->length -= length +1;
+  void *tail = stack->values[stack->length + length];
+  micolisp_list_builder builder;
+  micolisp_list_builder_init(&builder);
+  for (uint64_t index = 0; index < length; index++){
+    if (micolisp_list_builder_push(stack->values[stack->length + index], &builder) != 0){
+      micolisp_list_builder_abort(&builder, machine);
+      micolisp_decrease(tail, machine);
+      return 1;
+    }
   }
-  // define floor
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("floor", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_floor, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  void *list;
+  if (micolisp_list_builder_finish(tail, &builder, machine, &list) != 0){ return 1; }
+  if (micolisp_binary_stack_push(list, stack) != 0){
+    micolisp_decrease(list, machine);
+    return 1;
   }
-  // define ceil
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("ceil", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_ceil, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  micolisp_cons *cons = list;
+  for (uint64_t index = 0; index < length; index++, cons = cons->cdr){
+    if (micolisp_binary_stack_push(cons, &(reader->conses)) != 0){ return 1; }
   }
-  // define round
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("round", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_round, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return 0;
+}
+
+static int micolisp_binary_read_values (micolisp_binary_reader *reader, micolisp_machine *machine){
+  while (true){
+    int tag = getc_unlocked(reader->file);
+    void *value;
+    uint64_t integer;
+    switch (tag){
+      case MICOLISP_BINARY_END:
+        return reader->stack.length == 1? 0: micolisp_binary_broken();
+      case MICOLISP_BINARY_NIL:
+        value = MICOLISP_NIL;
+        break;
+      case MICOLISP_BINARY_T:
+        value = MICOLISP_T;
+        break;
+      case MICOLISP_BINARY_INTEGER:
+      case MICOLISP_BINARY_NUMBER: {
+        micolisp_number number;
+        if (tag == MICOLISP_BINARY_INTEGER){
+          if (micolisp_binary_read_varint(reader->file, &integer) != 0){ return 1; }
+          number = (double)(int64_t)((integer >> 1) ^ -(integer & 1));
+        }
+        else {
+          unsigned char buffer[sizeof(uint64_t)];
+          if (fread(buffer, 1, sizeof(buffer), reader->file) != sizeof(buffer)){ return micolisp_binary_broken(); }
+          uint64_t bits = 0;
+          for (size_t index = 0; index < sizeof(buffer); index++){ bits |= (uint64_t)buffer[index] << (index * 8); }
+          copy((char*)&bits, sizeof(number), (char*)&number);
+        }
+        micolisp_number *numberp = micolisp_allocate_number(machine);
+        if (numberp == NULL){ return 1; }
+        *numberp = number;
+        value = numberp;
+        break;
+      }
+      case MICOLISP_BINARY_SYMBOL:
+      case MICOLISP_BINARY_SHARED: {
+        micolisp_binary_stack *table = tag == MICOLISP_BINARY_SYMBOL? &(reader->symbols): &(reader->conses);
+        if (micolisp_binary_read_varint(reader->file, &integer) != 0){ return 1; }
+        if (table->length <= integer){ return micolisp_binary_broken(); }
+        value = table->values[integer];
+        if (micolisp_increase(value, machine) != 0){ return 1; }
+        break;
+      }
+      case MICOLISP_BINARY_LIST:
+        if (micolisp_binary_read_varint(reader->file, &integer) != 0){ return 1; }
+        if (micolisp_binary_read_list(integer, reader, machine) != 0){ return 1; }
+        continue;
+      default:
+        return micolisp_binary_broken();
+    }
+    if (micolisp_binary_stack_push(value, &(reader->stack)) != 0){
+      micolisp_decrease(value, machine);
+      return 1;
+    }
   }
-  // define ==
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("==", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_equal, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+}
+
+int micolisp_read_binary (FILE *file, micolisp_machine *machine, void **valuep){
+  char magic[MICOLISP_BINARY_MAGIC_LENGTH];
+  uint64_t version;
+  bool binaryp = fread(magic, 1, MICOLISP_BINARY_MAGIC_LENGTH, file) == MICOLISP_BINARY_MAGIC_LENGTH;
+  for (size_t index = 0; binaryp && index < MICOLISP_BINARY_MAGIC_LENGTH; index++){
+    binaryp = magic[index] == MICOLISP_BINARY_MAGIC[index];
   }
-  // define !=
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("!=", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_unequal, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  if (!binaryp || micolisp_binary_read_varint(file, &version) != 0 || version != MICOLISP_BINARY_VERSION){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was not a micolisp binary.");
+    return 1;
   }
-  // define <
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("<", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_less, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  micolisp_binary_reader reader = { file, { NULL, 0, 0 }, { NULL, 0, 0 }, { NULL, 0, 0 } };
+  flockfile(file);
+  int status = micolisp_binary_read_symbols(&reader, machine);
+  if (status == 0){ status = micolisp_binary_read_values(&reader, machine); }
+  funlockfile(file);
+  if (status == 0){
+    *valuep = reader.stack.values[0];
   }
-  // define <=
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("<=", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_less_or_equal, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else {
+    for (size_t index = 0; index < reader.stack.length; index++){ micolisp_decrease(reader.stack.values[index], machine); }
   }
-  // define >
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0(">", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_great, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  // the symbol table holds a count of each symbol.
+  for (size_t index = 0; index < reader.symbols.length; index++){ micolisp_decrease(reader.symbols.values[index], machine); }
+  free(reader.symbols.values);
+  free(reader.conses.values);
+  free(reader.stack.values);
+  return status;
+}
+
+// script 
+
+// read forms of a script are cached as a binary, keyed by the path, the size, the mtime and the hash of the source.
+// a cache whose mtime differs is still used when the hash matches, and its header is refreshed.
+// a source modified within a second of writing its cache is recorded without mtime, so it is always hashed.
+
+#define MICOLISP_CACHE_MAGIC "micolisp-cache\n"
+#define MICOLISP_CACHE_MAGIC_LENGTH 15
+#define MICOLISP_CACHE_VERSION 1
+#define MICOLISP_CACHE_EXTENSION ".fasl"
+
+typedef struct micolisp_cache_header {
+  char magic[16];
+  uint64_t version;
+  uint64_t size;
+  int64_t mtime;
+  int64_t mtimensec;
+  uint64_t hash;
+  uint64_t pathlength;
+} micolisp_cache_header;
+
+static char *micolisp_cache_path (char *path, micolisp_machine *machine){
+  size_t pathlength = strlen(path);
+  if (machine->cachedirectory == NULL){
+    char *cachepath = malloc(pathlength + sizeof(MICOLISP_CACHE_EXTENSION));
+    if (cachepath == NULL){ return NULL; }
+    copy(path, pathlength, cachepath);
+    copy(MICOLISP_CACHE_EXTENSION, sizeof(MICOLISP_CACHE_EXTENSION), cachepath + pathlength);
+    return cachepath;
+  }
+  // caches in a directory are named by the hash of the absolute path.
+  char *absolutepath = realpath(path, NULL);
+  char *key = absolutepath == NULL? path: absolutepath;
+  size_t size = strlen(machine->cachedirectory) + 1 + 16 + sizeof(MICOLISP_CACHE_EXTENSION);
+  char *cachepath = malloc(size);
+  if (cachepath != NULL){
+    snprintf(cachepath, size, "%s/%016llx%s", machine->cachedirectory, (unsigned long long)calculate_hash(key, strlen(key)), MICOLISP_CACHE_EXTENSION);
+  }
+  free(absolutepath);
+  return cachepath;
+}
+
+static bool micolisp_cache_header_validp (micolisp_cache_header *header, char *path, FILE *cache){
+  bool validp = header->version == MICOLISP_CACHE_VERSION && header->pathlength == strlen(path);
+  for (size_t index = 0; validp && index < MICOLISP_CACHE_MAGIC_LENGTH; index++){
+    validp = header->magic[index] == MICOLISP_CACHE_MAGIC[index];
+  }
+  for (size_t index = 0; validp && index < header->pathlength; index++){
+    validp = getc(cache) == (unsigned char)path[index];
+  }
+  return validp;
+}
+
+// a cache is evaluated as the script, so it is trusted only when it is owned by the user and only the user may write it.
+
+static bool micolisp_cache_trustedp (FILE *cache){
+  struct stat status;
+  return 
+    fstat(fileno(cache), &status) == 0 && 
+    S_ISREG(status.st_mode) && 
+    status.st_uid == geteuid() && 
+    (status.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// forms of a cache must be a proper list, or the cache is broken.
+
+static int micolisp_cache_read (FILE *cache, micolisp_machine *machine, void **formsp){
+  void *forms;
+  if (micolisp_read_binary(cache, machine, &forms) != 0){ return 1; }
+  void *rest = forms;
+  while (micolisp_typep(MICOLISP_CONS, rest, machine)){ rest = ((micolisp_cons*)rest)->cdr; }
+  if (rest != MICOLISP_NIL){
+    micolisp_decrease(forms, machine);
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "could not read the cache, because it was broken.");
+    return 1;
   }
-  // define >=
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0(">=", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_great_or_equal, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  *formsp = forms;
+  return 0;
+}
+
+static bool micolisp_cache_mtimep (micolisp_cache_header *header, struct stat *status){
+  return 
+    (header->mtime != 0 || header->mtimensec != 0) && 
+    header->mtime == status->st_mtim.tv_sec && 
+    header->mtimensec == status->st_mtim.tv_nsec;
+}
+
+static void micolisp_cache_header_init (char *path, struct stat *status, uint64_t hash, micolisp_cache_header *header){
+  *header = (micolisp_cache_header){ .version = MICOLISP_CACHE_VERSION, .size = status->st_size, .hash = hash, .pathlength = strlen(path) };
+  copy(MICOLISP_CACHE_MAGIC, MICOLISP_CACHE_MAGIC_LENGTH, header->magic);
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  if (status->st_mtim.tv_sec + 1 < now.tv_sec){
+    header->mtime = status->st_mtim.tv_sec;
+    header->mtimensec = status->st_mtim.tv_nsec;
+  }
+}
+
+// a cache is written to a temporary file and renamed, so readers never see a half written one.
+
+static int micolisp_cache_store (char *path, char *cachepath, micolisp_cache_header *header, void *forms, micolisp_machine *machine){
+  if (machine->cachedirectory != NULL){ mkdir(machine->cachedirectory, 0700); }
+  size_t length = strlen(cachepath);
+  char *temporarypath = malloc(length + 8);
+  if (temporarypath == NULL){ return 1; }
+  copy(cachepath, length, temporarypath);
+  copy(".XXXXXX", 8, temporarypath + length);
+  int descriptor = mkstemp(temporarypath);
+  FILE *cache = descriptor < 0? NULL: fdopen(descriptor, "wb");
+  int status = cache == NULL;
+  if (status == 0){ status = fwrite(header, 1, sizeof(*header), cache) != sizeof(*header); }
+  if (status == 0){ status = fwrite(path, 1, header->pathlength, cache) != header->pathlength; }
+  if (status == 0){ status = micolisp_write_binary(forms, cache, machine); }
+  if (cache != NULL && fclose(cache) != 0){ status = 1; }
+  if (cache == NULL && 0 <= descriptor){ close(descriptor); }
+  if (status == 0){ status = rename(temporarypath, cachepath) != 0; }
+  if (status != 0 && 0 <= descriptor){ remove(temporarypath); }
+  free(temporarypath);
+  return status;
+}
+
+static int micolisp_script_parse (char *sequence, size_t size, micolisp_machine *machine, void **formsp){
+  micolisp_source source;
+  micolisp_source_init_buffer(sequence, size, &source);
+  return micolisp_read_all(&source, machine, formsp);
+}
+
+int micolisp_read_script (char *path, micolisp_machine *machine, void **formsp){
+  FILE *file = fopen(path, "rb");
+  if (file == NULL){
+    micolisp_error_set0(MICOLISP_ERROR, "could not open the script.");
+    return 1;
   }
-  // define numberp
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("numberp", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_numberp, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  struct stat status;
+  if (!machine->scriptcache || fstat(fileno(file), &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0){
+    int result = micolisp_read_file(file, machine, formsp);
+    fclose(file);
+    return result;
+  }
+  // failures of the cache are not errors of the script, so the error is restored.
+  micolisp_error_info error = micolisp_error;
+  char *cachepath = micolisp_cache_path(path, machine);
+  FILE *cache = cachepath == NULL? NULL: fopen(cachepath, "r+b");
+  micolisp_cache_header header;
+  bool validp = 
+    cache != NULL && 
+    micolisp_cache_trustedp(cache) && 
+    fread(&header, 1, sizeof(header), cache) == sizeof(header) && 
+    micolisp_cache_header_validp(&header, path, cache) && 
+    header.size == (uint64_t)status.st_size;
+  if (validp && micolisp_cache_mtimep(&header, &status) && micolisp_cache_read(cache, machine, formsp) == 0){
+    fclose(cache);
+    fclose(file);
+    free(cachepath);
+    micolisp_error = error;
+    return 0;
   }
-  // define symbolp
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("symbolp", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_symbolp, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  char *sequence = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+  fclose(file);
+  if (sequence == MAP_FAILED){
+    if (cache != NULL){ fclose(cache); }
+    free(cachepath);
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function mmap() was failed.");
+    return 1;
   }
-  // define functionp
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("functionp", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_functionp, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  uint64_t hash = calculate_hash(sequence, status.st_size);
+  micolisp_cache_header newheader;
+  micolisp_cache_header_init(path, &status, hash, &newheader);
+  int result;
+  if (validp && header.hash == hash && micolisp_cache_read(cache, machine, formsp) == 0){
+    // the source was touched but not changed.
+    if (fseek(cache, 0, SEEK_SET) == 0){ fwrite(&newheader, 1, sizeof(newheader), cache); }
+    micolisp_error = error;
+    result = 0;
   }
-  // define consp
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("consp", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_consp, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else {
+    result = micolisp_script_parse(sequence, status.st_size, machine, formsp);
+    if (result == 0){
+      if (cachepath != NULL){ micolisp_cache_store(path, cachepath, &newheader, *formsp, machine); }
+      micolisp_error = error;
+    }
   }
-  // define listp
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("listp", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_listp, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  munmap(sequence, status.st_size);
+  if (cache != NULL){ fclose(cache); }
+  free(cachepath);
+  return result;
+}
+
+// forms are evaluated and printed as same as micolisp_repl.
+// a script which could not be read is given to micolisp_repl, so the forms before a syntax error are still evaluated.
+
+int micolisp_run_script (char *path, FILE *output, FILE *error, micolisp_machine *machine){
+  void *forms;
+  if (micolisp_read_script(path, machine, &forms) != 0){
+    FILE *file = fopen(path, "r");
+    if (file == NULL){ print_error(error); return 1; }
+    int status = micolisp_repl(file, output, error, machine);
+    fclose(file);
+    return status;
   }
-  // define read
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("read", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  int status = 0;
+  for (micolisp_cons *cons = forms; status == 0 && cons != NULL; cons = cons->cdr){
+    if (micolisp_arena_begin(machine) != 0){
+      print_error(error);
+      status = 1;
+      break;
+    }
+    void *value;
+    status = micolisp_eval(cons->car, machine, &value);
+    if (status == 0){
+      status = micolisp_println(value, output, machine);
+      if (micolisp_decrease(value, machine) != 0){ status = 1; }
+    }
+    if (status != 0){ print_error(error); }
+    if (micolisp_arena_end(machine) != 0 && status == 0){
+      print_error(error);
+      status = 1;
+    }
   }
-  // define read-string
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("read-string", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read_string, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  if (micolisp_decrease(forms, machine) != 0){ return 1; }
+  return status;
+}
+
+// segment 
+
+// a segment is a file of numbers, symbols and conses written for a base address.
+// it is mapped shared and read-only at the base when the address is free and no name conflicts,
+// otherwise it is mapped privately and its pointers are relocated.
+
+#define MICOLISP_SEGMENT_MAGIC "micolisp-heap\n"
+#define MICOLISP_SEGMENT_MAGIC_LENGTH 14
+#define MICOLISP_SEGMENT_VERSION 2
+#define MICOLISP_SEGMENT_BASE ((uintptr_t)0x100000000000)
+#define MICOLISP_SEGMENT_BASE_SLOTS 4096
+#define MICOLISP_SEGMENT_BASE_ALIGNMENT ((uintptr_t)0x40000000)
+
+typedef struct micolisp_segment_header {
+  char magic[16];
+  uint64_t version;
+  uint64_t base;
+  uint64_t size;
+  uint64_t numbers;
+  uint64_t numberslength;
+  uint64_t symbols;
+  uint64_t symbolslength;
+  uint64_t conses;
+  uint64_t conseslength;
+  uint64_t strings;
+  uint64_t root;
+} micolisp_segment_header;
+
+typedef struct micolisp_segment_objects {
+  void **addresses;
+  size_t length;
+  size_t capacity;
+} micolisp_segment_objects;
+
+typedef struct micolisp_segment_writer {
+  hashtable placed; // address -> index + 1 in the objects of its type.
+  micolisp_segment_objects numbers;
+  micolisp_segment_objects symbols;
+  micolisp_segment_objects conses;
+  size_t stringssize;
+} micolisp_segment_writer;
+
+static bool micolisp_segment_typep (micolisp_memory_type type, void *address, micolisp_segment *segment){
+  for (; segment != NULL; segment = segment->next){
+    switch (type){
+      case MICOLISP_NUMBER: 
+        if ((void*)segment->numbers <= address && address < (void*)(segment->numbers + segment->numberslength)){ return true; }
+        break;
+      case MICOLISP_SYMBOL: 
+        if ((void*)segment->symbols <= address && address < (void*)(segment->symbols + segment->symbolslength)){ return true; }
+        break;
+      case MICOLISP_CONS: 
+        if ((void*)segment->conses <= address && address < (void*)(segment->conses + segment->conseslength)){ return true; }
+        break;
+      default: 
+        break;
+    }
   }
-  // define read-line
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("read-line", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_read_line, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return false;
+}
+
+bool micolisp_segmentp (void *address, micolisp_machine *machine){
+  return 
+    micolisp_segment_typep(MICOLISP_CONS, address, machine->segments) || 
+    micolisp_segment_typep(MICOLISP_NUMBER, address, machine->segments) || 
+    micolisp_segment_typep(MICOLISP_SYMBOL, address, machine->segments);
+}
+
+static int micolisp_segment_objects_push (void *address, micolisp_segment_objects *objects, hashtable *placed){
+  if (objects->capacity <= objects->length){
+    size_t newcapacity = MAX(64, objects->capacity * 2);
+    void **newaddresses = realloc(objects->addresses, newcapacity * sizeof(void*));
+    if (newaddresses == NULL){
+      micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function realloc() was failed.");
+      return 1;
+    }
+    objects->addresses = newaddresses;
+    objects->capacity = newcapacity;
   }
-  // define eval
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("eval", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_eval, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  objects->addresses[objects->length] = address;
+  objects->length += 1;
+  return address_table_set((void*)(uintptr_t)objects->length, address, placed);
+}
+
+static int micolisp_segment_collect (void *value, micolisp_segment_writer *writer, micolisp_machine *machine){
+  void *found;
+  while (value != MICOLISP_NIL && value != MICOLISP_T && hashtable_get(value, &(writer->placed), &found) != 0){
+    if (micolisp_typep(MICOLISP_NUMBER, value, machine)){
+      return micolisp_segment_objects_push(value, &(writer->numbers), &(writer->placed));
+    }
+    else 
+    if (micolisp_typep(MICOLISP_SYMBOL, value, machine)){
+      writer->stringssize += align_size(sizeof(size_t) + ((micolisp_symbol*)value)->length, sizeof(size_t));
+      return micolisp_segment_objects_push(value, &(writer->symbols), &(writer->placed));
+    }
+    else 
+    if (micolisp_typep(MICOLISP_CONS, value, machine)){
+      if (micolisp_segment_objects_push(value, &(writer->conses), &(writer->placed)) != 0){ return 1; }
+      if (micolisp_segment_collect(((micolisp_cons*)value)->car, writer, machine) != 0){ return 1; }
+      value = ((micolisp_cons*)value)->cdr;
+    }
+    else {
+      micolisp_error_set0(MICOLISP_TYPE_ERROR, "segment could hold only numbers, symbols and conses.");
+      return 1;
+    }
   }
-  // define eval-string
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("eval-string", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_eval_string, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  return 0;
+}
+
+static void *micolisp_segment_encode (void *value, micolisp_segment_writer *writer, micolisp_segment_header *header, micolisp_machine *machine){
+  if (value == MICOLISP_NIL || value == MICOLISP_T){ return value; }
+  void *found;
+  hashtable_get(value, &(writer->placed), &found);
+  size_t index = (uintptr_t)found -1;
+  if (micolisp_typep(MICOLISP_NUMBER, value, machine)){
+    return (void*)(uintptr_t)(header->base + header->numbers + index * sizeof(micolisp_number_cell));
   }
-  // define print
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("print", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_print, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else 
+  if (micolisp_typep(MICOLISP_SYMBOL, value, machine)){
+    return (void*)(uintptr_t)(header->base + header->symbols + index * sizeof(micolisp_symbol));
   }
-  // define println
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("println", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_println, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  else {
+    return (void*)(uintptr_t)(header->base + header->conses + index * sizeof(micolisp_cons));
   }
-  // define write
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("write", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_write, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+}
+
+static void micolisp_segment_writer_free (micolisp_segment_writer *writer){
+  free(writer->placed.entries);
+  free(writer->numbers.addresses);
+  free(writer->symbols.addresses);
+  free(writer->conses.addresses);
+}
+
+int micolisp_save_segment (FILE *file, void *value, micolisp_machine *machine){
+  void *valuedereferenced;
+  if (micolisp_reference_get(value, machine, &valuedereferenced) != 0){ return 1; }
+  micolisp_segment_writer writer = { .stringssize = 0 };
+  hashtable_init(NULL, 0, MICOLISP_ADDRESS_CLASS, &(writer.placed));
+  if (micolisp_segment_collect(valuedereferenced, &writer, machine) != 0){
+    micolisp_segment_writer_free(&writer);
+    return 1;
   }
-  // define writeln
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("writeln", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_writeln, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  micolisp_segment_header header;
+  memset(&header, 0, sizeof(header));
+  copy(MICOLISP_SEGMENT_MAGIC, MICOLISP_SEGMENT_MAGIC_LENGTH, header.magic);
+  header.version = MICOLISP_SEGMENT_VERSION;
+  header.numbers = align_size(sizeof(header), 64);
+  header.numberslength = writer.numbers.length;
+  header.symbols = align_size(header.numbers + writer.numbers.length * sizeof(micolisp_number_cell), 64);
+  header.symbolslength = writer.symbols.length;
+  header.conses = align_size(header.symbols + writer.symbols.length * sizeof(micolisp_symbol), 64);
+  header.conseslength = writer.conses.length;
+  header.strings = align_size(header.conses + writer.conses.length * sizeof(micolisp_cons), 64);
+  header.size = align_size(header.strings + writer.stringssize, 4096);
+  // the base is spread over slots, so segments of one process rarely collide.
+  header.base = MICOLISP_SEGMENT_BASE + (calculate_hash((char*)&(header.size), sizeof(header.size)) ^ micolisp_clock()) % MICOLISP_SEGMENT_BASE_SLOTS * MICOLISP_SEGMENT_BASE_ALIGNMENT;
+  char *sequence = calloc(1, header.size);
+  if (sequence == NULL){
+    micolisp_segment_writer_free(&writer);
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function calloc() was failed.");
+    return 1;
   }
-  // define error
-  {
-    micolisp_symbol *symbol = micolisp_allocate_symbol0("error", machine);
-    if (symbol == NULL){ return 1; }
-    micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, __micolisp_error, machine);
-    if (function == NULL){ return 1; }
-    if (micolisp_scope_set(function, symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(symbol, machine) != 0){ return 1; }
-    if (micolisp_decrease(function, machine) != 0){ return 1; }
+  micolisp_number_cell *numbers = (micolisp_number_cell*)(sequence + header.numbers);
+  for (size_t index = 0; index < writer.numbers.length; index++){
+    numbers[index].number = *(micolisp_number*)(writer.numbers.addresses[index]);
+    numbers[index].references = 1;
+  }
+  micolisp_symbol *symbols = (micolisp_symbol*)(sequence + header.symbols);
+  size_t stringoffset = header.strings;
+  for (size_t index = 0; index < writer.symbols.length; index++){
+    micolisp_symbol *symbol = writer.symbols.addresses[index];
+    *(size_t*)(sequence + stringoffset) = symbol->length;
+    copy(symbol->characters, symbol->length, sequence + stringoffset + sizeof(size_t));
+    symbols[index] = *symbol;
+    symbols[index].characters = (char*)(uintptr_t)(header.base + stringoffset + sizeof(size_t));
+    symbols[index].references = 1;
+    stringoffset += align_size(sizeof(size_t) + symbol->length, sizeof(size_t));
+  }
+  micolisp_cons *conses = (micolisp_cons*)(sequence + header.conses);
+  for (size_t index = 0; index < writer.conses.length; index++){
+    micolisp_cons *cons = writer.conses.addresses[index];
+    conses[index].car = micolisp_segment_encode(cons->car, &writer, &header, machine);
+    conses[index].cdr = micolisp_segment_encode(cons->cdr, &writer, &header, machine);
+  }
+  header.root = (uintptr_t)micolisp_segment_encode(valuedereferenced, &writer, &header, machine);
+  copy((char*)&header, sizeof(header), sequence);
+  micolisp_segment_writer_free(&writer);
+  size_t written = fwrite(sequence, 1, header.size, file);
+  free(sequence);
+  if (written != header.size){
+    micolisp_error_set0(MICOLISP_ERROR, "could not write the segment.");
+    return 1;
   }
-  // define not 
-  {
-    char source[] = "(function not (any) (if any nil t))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  return 0;
+}
+
+static void *micolisp_segment_relocate (void *value, intptr_t delta){
+  if (value == MICOLISP_NIL || value == MICOLISP_T){ return value; }
+  return (char*)value + delta;
+}
+
+// a symbol already interned in the machine takes the place of the symbol of the segment.
+
+static void *micolisp_segment_resolve (void *value, micolisp_segment *segment){
+  if (micolisp_segment_typep(MICOLISP_SYMBOL, value, segment)){
+    return segment->resolved[(micolisp_symbol*)value - segment->symbols];
   }
-  // define null 
-  {
-    char source[] = "(var null not)";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  return value;
+}
+
+static micolisp_symbol *micolisp_symbol_find (micolisp_symbol *symbol, micolisp_machine *machine){
+  void *foundsymbol;
+  for (; machine != NULL; machine = machine->origin){
+    if (hashset_get(symbol, &(machine->symbol), &foundsymbol) == 0){ return foundsymbol; }
   }
-  // define length
-  {
-    char source[] = "(function length (lst) (if (null lst) 0 (+ (length (cdr lst)) 1)))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  return NULL;
+}
+
+// the first length symbols of a segment are taken back from the machine.
+
+static void micolisp_segment_unregister (micolisp_segment *segment, size_t length, micolisp_machine *machine){
+  for (size_t index = 0; index < length; index++){
+    micolisp_symbol *symbol = &(segment->symbols[index]);
+    if (segment->resolved[index] != symbol){
+      micolisp_decrease(segment->resolved[index], machine);
+      continue;
+    }
+    hashset_delete(symbol, &(machine->symbol));
+    machine->symbollength -= 1;
   }
-  // define nth
-  {
-    char source[] = "(function nth (index lst) (if (null lst) nil (if (<= index 0) (car lst) (nth (- index 1) (cdr lst)))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+}
+
+static int micolisp_segment_register (micolisp_segment *segment, micolisp_machine *machine){
+  for (size_t index = 0; index < segment->symbolslength; index++){
+    micolisp_symbol *symbol = &(segment->symbols[index]);
+    if (segment->resolved[index] != symbol){
+      if (micolisp_increase(segment->resolved[index], machine) != 0){
+        micolisp_segment_unregister(segment, index, machine);
+        return 1;
+      }
+      continue;
+    }
+    // a name written twice in one segment could not be told apart in the symbol table.
+    void *found;
+    if (hashset_get(symbol, &(machine->symbol), &found) == 0){
+      micolisp_segment_unregister(segment, index, machine);
+      micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was a broken micolisp segment.");
+      return 1;
+    }
+    if (hashset_add(symbol, &(machine->symbol)) != 0){
+      if (micolisp_symbol_table_resize(MAX(8, machine->symbol.length * 2), machine) != 0 || hashset_add(symbol, &(machine->symbol)) != 0){
+        micolisp_segment_unregister(segment, index, machine);
+        micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function hashset_add() was failed."); 
+        return 1;
+      }
+    }
+    machine->symbollength += 1;
   }
-  // define map
-  {
-    char source[] = "(function map (fn lst) (if (null lst) nil (cons (fn (car lst)) (map fn (cdr lst)))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  return 0;
+}
+
+// a segment which could not be attached is taken out of the machine and unmapped.
+
+static void micolisp_segment_detach (micolisp_segment *segment, micolisp_machine *machine){
+  micolisp_segment **link = &(machine->segments);
+  while (*link != NULL && *link != segment){ link = &((*link)->next); }
+  if (*link != NULL){ *link = segment->next; }
+  munmap(segment->sequence, segment->size);
+  free(segment->resolved);
+  free(segment);
+}
+
+// the file is checked before any pointer of it is followed,
+// so a truncated or broken segment is refused instead of read out of its mapping.
+
+static bool micolisp_segment_sectionp (uint64_t offset, uint64_t length, size_t size, uint64_t end){
+  return offset % sizeof(void*) == 0 && offset <= end && length <= (end - offset) / size;
+}
+
+static bool micolisp_segment_headerp (micolisp_segment_header *header, FILE *file){
+  struct stat status;
+  if (fstat(fileno(file), &status) != 0 || status.st_size < 0){ return false; }
+  return 
+    sizeof(micolisp_segment_header) <= header->size && 
+    header->size <= (uint64_t)status.st_size && 
+    header->size <= SIZE_MAX && 
+    header->base % 4096 == 0 && 
+    header->base <= UINTPTR_MAX - header->size && 
+    sizeof(micolisp_segment_header) <= header->numbers && 
+    micolisp_segment_sectionp(header->numbers, header->numberslength, sizeof(micolisp_number_cell), header->symbols) && 
+    micolisp_segment_sectionp(header->symbols, header->symbolslength, sizeof(micolisp_symbol), header->conses) && 
+    micolisp_segment_sectionp(header->conses, header->conseslength, sizeof(micolisp_cons), header->strings) && 
+    header->strings <= header->size;
+}
+
+static bool micolisp_segment_elementp (uint64_t offset, uint64_t start, uint64_t length, size_t size){
+  return start <= offset && (offset - start) % size == 0 && (offset - start) / size < length;
+}
+
+// a value is checked as written, relative to the base, before it is relocated.
+
+static bool micolisp_segment_valuep (void *value, micolisp_segment_header *header){
+  if (value == MICOLISP_NIL || value == MICOLISP_T){ return true; }
+  uint64_t address = (uintptr_t)value;
+  if (address < header->base){ return false; }
+  uint64_t offset = address - header->base;
+  return 
+    micolisp_segment_elementp(offset, header->numbers, header->numberslength, sizeof(micolisp_number_cell)) || 
+    micolisp_segment_elementp(offset, header->symbols, header->symbolslength, sizeof(micolisp_symbol)) || 
+    micolisp_segment_elementp(offset, header->conses, header->conseslength, sizeof(micolisp_cons));
+}
+
+static bool micolisp_segment_symbolp (micolisp_symbol *symbol, char *sequence, micolisp_segment_header *header){
+  uint64_t address = (uintptr_t)symbol->characters;
+  if (address < header->base){ return false; }
+  uint64_t offset = address - header->base;
+  if (offset % sizeof(size_t) != 0 || offset < header->strings + sizeof(size_t) || header->size < offset){ return false; }
+  if (header->size - offset < symbol->length){ return false; }
+  if (*(size_t*)(sequence + offset - sizeof(size_t)) != symbol->length){ return false; }
+  return symbol->hash == calculate_hash(sequence + offset, symbol->length);
+}
+
+static bool micolisp_segment_contentp (char *sequence, micolisp_segment_header *header){
+  micolisp_symbol *symbols = (micolisp_symbol*)(sequence + header->symbols);
+  for (size_t index = 0; index < header->symbolslength; index++){
+    if (!micolisp_segment_symbolp(&(symbols[index]), sequence, header)){ return false; }
   }
-  // define filter
-  {
-    char source[] = "(function filter (fn lst) (if (null lst) nil (if (fn (car lst)) (cons (car lst) (filter fn (cdr lst))) (filter fn (cdr lst)))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  micolisp_cons *conses = (micolisp_cons*)(sequence + header->conses);
+  for (size_t index = 0; index < header->conseslength; index++){
+    if (!micolisp_segment_valuep(conses[index].car, header) || !micolisp_segment_valuep(conses[index].cdr, header)){ return false; }
   }
-  // define --reduce
-  {
-    char source[] = "(function --reduce (fn acc lst) (if (null lst) acc (--reduce fn (fn acc (car lst)) (cdr lst))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  return micolisp_segment_valuep((void*)(uintptr_t)header->root, header);
+}
+
+// the file is mapped privately at first, so its names are compared with the machine.
+// when no name is taken and the base is free, the private mapping is replaced by the shared one.
+
+static int micolisp_segment_map (FILE *file, micolisp_segment_header *header, micolisp_segment *segment, micolisp_machine *machine){
+  char *sequence = mmap(NULL, header->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+  if (sequence == MAP_FAILED){
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function mmap() was failed.");
+    return 1;
   }
-  // define reduce
-  {
-    char source[] = "(function reduce (fn lst) (if (null lst) nil (--reduce fn (car lst) (cdr lst))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  if (!micolisp_segment_contentp(sequence, header)){
+    munmap(sequence, header->size);
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was a broken micolisp segment.");
+    return 1;
   }
-  // define find
-  {
-    char source[] = "(function find (fn lst) (if (null lst) nil (if (fn (car lst)) (car lst) (find fn (cdr lst)))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  intptr_t delta = (intptr_t)sequence - (intptr_t)header->base;
+  micolisp_symbol *symbols = (micolisp_symbol*)(sequence + header->symbols);
+  bool conflicted = false;
+  for (size_t index = 0; index < header->symbolslength; index++){
+    symbols[index].characters = micolisp_segment_relocate(symbols[index].characters, delta);
+    micolisp_symbol *found = micolisp_symbol_find(&(symbols[index]), machine);
+    segment->resolved[index] = found;
+    conflicted = conflicted || found != NULL;
+  }
+  segment->shared = false;
+  if (!conflicted){
+    void *base = (void*)(uintptr_t)header->base;
+#ifdef MAP_FIXED_NOREPLACE
+    char *sharedsequence = mmap(base, header->size, PROT_READ, MAP_SHARED | MAP_FIXED_NOREPLACE, fileno(file), 0);
+#else
+    char *sharedsequence = mmap(base, header->size, PROT_READ, MAP_SHARED, fileno(file), 0);
+#endif
+    if (sharedsequence == base){
+      munmap(sequence, header->size);
+      sequence = sharedsequence;
+      delta = 0;
+      segment->shared = true;
+    }
+    else 
+    if (sharedsequence != MAP_FAILED){
+      munmap(sharedsequence, header->size);
+    }
   }
+  segment->sequence = sequence;
+  segment->size = header->size;
+  segment->numbers = (micolisp_number_cell*)(sequence + header->numbers);
+  segment->numberslength = header->numberslength;
+  segment->symbols = (micolisp_symbol*)(sequence + header->symbols);
+  segment->symbolslength = header->symbolslength;
+  segment->conses = (micolisp_cons*)(sequence + header->conses);
+  segment->conseslength = header->conseslength;
+  segment->next = NULL;
+  for (size_t index = 0; index < header->symbolslength; index++){
+    if (segment->resolved[index] == NULL){ segment->resolved[index] = &(segment->symbols[index]); }
+  }
+  if (!segment->shared){
+    for (size_t index = 0; index < header->conseslength; index++){
+      micolisp_cons *cons = &(segment->conses[index]);
+      cons->car = micolisp_segment_resolve(micolisp_segment_relocate(cons->car, delta), segment);
+      cons->cdr = micolisp_segment_resolve(micolisp_segment_relocate(cons->cdr, delta), segment);
+    }
+    mprotect(sequence, header->size, PROT_READ);
+  }
+  header->root = (uintptr_t)micolisp_segment_resolve(micolisp_segment_relocate((void*)(uintptr_t)header->root, delta), segment);
   return 0;
 }
 
-// setup macro 
-
-static int setup_builtin_macro (micolisp_machine *machine){
-  // define until 
-  {
-    char source[] = "(macro until (cond &rest forms) (cons 'while (cons (list 'not cond) forms)))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+int micolisp_attach_segment (FILE *file, char *name, micolisp_machine *machine){
+  micolisp_segment_header header;
+  bool segmentp = fseek(file, 0, SEEK_SET) == 0 && fread(&header, 1, sizeof(header), file) == sizeof(header);
+  segmentp = segmentp && header.version == MICOLISP_SEGMENT_VERSION;
+  for (size_t index = 0; index < MICOLISP_SEGMENT_MAGIC_LENGTH; index++){
+    segmentp = segmentp && header.magic[index] == MICOLISP_SEGMENT_MAGIC[index];
   }
-  // define when
-  {
-    char source[] = "(macro when (cond &rest forms) (list 'if cond (cons 'progn forms) nil))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  if (!segmentp){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was not a micolisp segment.");
+    return 1;
   }
-  // define unless 
-  {
-    char source[] = "(macro unless (cond &rest forms) (list 'if cond nil (cons 'progn forms)))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  if (!micolisp_segment_headerp(&header, file)){
+    micolisp_error_set0(MICOLISP_VALUE_ERROR, "given file was a broken micolisp segment.");
+    return 1;
   }
-  // define and 
-  {
-    char source[] = "(macro and (&rest forms) (if (null forms) t (if (null (cdr forms)) (car forms) (list 'if (car forms) (cons 'and (cdr forms)) nil))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  micolisp_segment *segment = malloc(sizeof(micolisp_segment));
+  micolisp_symbol **resolved = malloc(MAX(1, header.symbolslength) * sizeof(micolisp_symbol*));
+  if (segment == NULL || resolved == NULL){
+    free(segment);
+    free(resolved);
+    micolisp_error_set0(MICOLISP_INTERNAL_ERROR, "internal function malloc() was failed.");
+    return 1;
   }
-  // define or 
-  {
-    char source[] = "(macro or (&rest forms) (if (null forms) nil (list 'progn (list 'var '--temp (car forms)) (list 'if '--temp '--temp (cons 'or (cdr forms))))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  segment->resolved = resolved;
+  if (micolisp_segment_map(file, &header, segment, machine) != 0){
+    free(segment);
+    free(resolved);
+    return 1;
   }
-  // define cond 
-  {
-    char source[] = "(macro cond (&rest conds) (if (null conds) nil (list 'if (car (car conds)) (cons 'progn (cdr (car conds))) (cons 'cond (cdr conds)))))";
-    void *value;
-    if (micolisp_eval_string0(source, machine, &value) != 0){ return 1; }
-    if (micolisp_decrease(value, machine) != 0){ return 1; }
+  segment->next = machine->segments;
+  machine->segments = segment;
+  if (micolisp_segment_register(segment, machine) != 0){
+    micolisp_segment_detach(segment, machine);
+    return 1;
+  }
+  micolisp_symbol *symbol = micolisp_allocate_symbol0(name, machine);
+  if (symbol == NULL){
+    micolisp_segment_unregister(segment, segment->symbolslength, machine);
+    micolisp_segment_detach(segment, machine);
+    return 1;
   }
+  if (micolisp_scope_set((void*)(uintptr_t)header.root, symbol, machine) != 0){
+    micolisp_decrease(symbol, machine);
+    micolisp_segment_unregister(segment, segment->symbolslength, machine);
+    micolisp_segment_detach(segment, machine);
+    return 1;
+  }
+  if (micolisp_decrease(symbol, machine) != 0){ return 1; }
   return 0;
 }
 
+static void micolisp_segment_free_all (micolisp_segment *segment){
+  while (segment != NULL){
+    micolisp_segment *next = segment->next;
+    munmap(segment->sequence, segment->size);
+    free(segment->resolved);
+    free(segment);
+    segment = next;
+  }
+}
+
 // micolisp 
 
 int micolisp_open (micolisp_machine *machine){
@@ -2938,11 +7315,50 @@ int micolisp_open (micolisp_machine *machine){
 int micolisp_load_library (micolisp_machine *machine){
   if (setup_builtin_syntax(machine) != 0){ return 1; }
   if (setup_builtin_function(machine) != 0){ return 1; }
+  if (setup_builtin_lisp_function(machine) != 0){ return 1; }
   if (setup_builtin_macro(machine) != 0){ return 1; }
   return 0;
 }
 
+// the clone has its own heap and a root scope over the scope of the origin,
+// so objects of the origin are shared without copy, and the clone binds names in its own root.
+// the origin must not be evaluated or closed while its clones are open.
+
+int micolisp_clone (micolisp_machine *origin, micolisp_machine *machine){
+  if (origin->scope == NULL){
+    micolisp_error_set0(MICOLISP_ERROR, "could not clone the machine, because it was not opened.");
+    return 1;
+  }
+  micolisp_init(machine);
+  machine->freebudget = origin->freebudget;
+  machine->arenamode = origin->arenamode;
+  machine->pausetarget = origin->pausetarget;
+  machine->regionsize = origin->regionsize;
+  machine->hugepage = origin->hugepage;
+  machine->numberreuse = origin->numberreuse;
+  machine->printprecision = origin->printprecision;
+  machine->scriptcache = origin->scriptcache;
+  machine->cachedirectory = origin->cachedirectory;
+  machine->origin = origin;
+  if (micolisp_scope_begin(machine) != 0){ return 1; }
+  machine->scope->parent = origin->scope;
+  origin->clones += 1;
+  return 0;
+}
+
 int micolisp_close (micolisp_machine *machine){
+  if (0 < machine->clones){
+    micolisp_error_set0(MICOLISP_ERROR, "could not close the machine, because its clones are open.");
+    return 1;
+  }
+  if (machine->origin != NULL){
+    machine->origin->clones -= 1;
+  }
   micolisp_memory_free(&(machine->memory));
+  micolisp_free_stack_free(&(machine->freestack));
+  micolisp_arena_free(&(machine->arena));
+  free_micolisp_arena_node_all(machine->strings);
+  micolisp_segment_free_all(machine->segments);
+  machine->segments = NULL;
   return 0;
 }
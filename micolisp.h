@@ -12,17 +12,22 @@
 #define MICOLISP_NIL NULL
 #define MICOLISP_T ((void*)~0)
 
-#define MICOLISP_SYMBOL_MAX_LENGTH 32
 #define MICOLISP_ERROR_INFO_MAX_LENGTH 256
 
 struct micolisp_machine;
 
 typedef double micolisp_number;
 
+typedef struct micolisp_number_cell {
+  micolisp_number number; // first, so a cell is read as a number.
+  size_t references; // mirrors the count like symbols.
+} micolisp_number_cell;
+
 typedef struct micolisp_symbol {
-  char characters[MICOLISP_SYMBOL_MAX_LENGTH];
+  char *characters; // interned in the string arena of the machine.
   size_t length;
   size_t hash;
+  size_t references; // mirrors the count, the symbol table does not hold one.
 } micolisp_symbol;
 
 typedef struct micolisp_cons {
@@ -66,6 +71,7 @@ typedef struct micolisp_user_function {
 typedef struct micolisp_scope {
   hashtable hashtable;
   struct micolisp_scope *parent;
+  bool escaped; // referred by a scope reference or an escaped child.
 } micolisp_scope;
 
 typedef struct micolisp_scope_reference { 
@@ -86,6 +92,27 @@ typedef enum micolisp_memory_type {
   MICOLISP_HASHSET_ENTRY,
 } micolisp_memory_type;
 
+#define MICOLISP_MEMORY_TYPE_LENGTH (MICOLISP_HASHSET_ENTRY + 1)
+
+// live counts numbers and symbols, which mirror their counts, and the objects of the arena, which are released with it.
+// other objects are released inside cgcmemnode, which does not tell when a count reaches zero, so they are left out of live.
+
+typedef struct micolisp_memory_count {
+  size_t allocated; // objects allocated since the machine was opened.
+  size_t allocatedbytes;
+  size_t live; // objects allocated and not yet released.
+  size_t livebytes;
+  size_t reserved; // bytes of cgcmemnode chain and arena nodes.
+  size_t peak; // high-water mark of reserved.
+} micolisp_memory_count;
+
+typedef struct micolisp_memory_account {
+  micolisp_memory_count counts[MICOLISP_MEMORY_TYPE_LENGTH];
+  micolisp_memory_count total;
+  size_t limits[MICOLISP_MEMORY_TYPE_LENGTH]; // reserved bytes per type, 0 means unlimited.
+  size_t limit; // reserved bytes of all types, 0 means unlimited.
+} micolisp_memory_account;
+
 typedef struct micolisp_memory {
   cgcmemnode *number;
   cgcmemnode *symbol;
@@ -97,12 +124,133 @@ typedef struct micolisp_memory {
   cgcmemnode *scopereference;
   cgcmemnode *hashtableentry;
   cgcmemnode *hashsetentry;
+  char *low; // lowest address of the allocated objects.
+  char *high; // end of the highest allocated object, so the heap lies in [low, high).
 } micolisp_memory;
 
+typedef enum micolisp_arena_mode {
+  MICOLISP_ARENA_NONE,
+  MICOLISP_ARENA_READ,
+  MICOLISP_ARENA_EVAL,
+} micolisp_arena_mode;
+
+typedef struct micolisp_arena_node {
+  size_t size;
+  size_t used;
+  struct micolisp_arena_node *next;
+  char *sequence;
+  size_t mapped; // bytes of the region reserved with mmap, 0 means the node was malloced.
+  size_t committed; // bytes of the sequence readable and writable.
+  size_t objects; // allocated in the node, taken from the live count when the node is released.
+  size_t bytes;
+} micolisp_arena_node;
+
+typedef struct micolisp_arena_range {
+  micolisp_arena_node *node;
+  micolisp_memory_type type;
+} micolisp_arena_range;
+
+typedef struct micolisp_arena {
+  micolisp_arena_node *number;
+  micolisp_arena_node *cons;
+  micolisp_arena_node *consreference;
+  micolisp_arena_range *ranges; // nodes of all types sorted by their sequences.
+  size_t rangeslength;
+  size_t rangescapacity;
+  void **externals;
+  size_t externalslength;
+  size_t externalscapacity;
+  size_t depth;
+  bool active;
+} micolisp_arena;
+
+#define MICOLISP_FREE_NO_PARENT SIZE_MAX
+
+typedef struct micolisp_free_entry {
+  void *address;
+  size_t root; // index of the entry released by micolisp_decrease().
+  size_t shadow; // index of the previous entry of the same address in the path.
+  bool visited;
+} micolisp_free_entry;
+
+typedef struct micolisp_free_stack {
+  micolisp_free_entry *entries;
+  size_t length;
+  size_t capacity;
+  size_t *slots; // open addressing from addresses to index + 1 of their latest visited entries, 0 is empty.
+  size_t slotslength; // power of two.
+  size_t slotscount; // addresses in the slots and the old slots.
+  size_t *oldslots; // slots before the last stretch, moved to the slots little by little.
+  size_t oldslotslength;
+  size_t oldslotsindex;
+} micolisp_free_stack;
+
+typedef struct micolisp_pause {
+  uint64_t count;
+  uint64_t last; // nanoseconds.
+  uint64_t max; // nanoseconds.
+  uint64_t total; // nanoseconds.
+} micolisp_pause;
+
+#define MICOLISP_LIST_BUILDER_BUFFER_LENGTH 16
+
+typedef struct micolisp_list_builder {
+  void **values; // buffer until it is stretched.
+  size_t length;
+  size_t capacity;
+  void *buffer[MICOLISP_LIST_BUILDER_BUFFER_LENGTH];
+} micolisp_list_builder;
+
+#define MICOLISP_ENTRIES_CLASS_LENGTH 16
+#define MICOLISP_STRING_CLASS_LENGTH 32
+
+typedef struct micolisp_pool {
+  micolisp_scope *scopes; // linked by parent.
+  hashtable_entry *entries[MICOLISP_ENTRIES_CLASS_LENGTH];
+} micolisp_pool;
+
+typedef struct micolisp_segment {
+  char *sequence;
+  size_t size;
+  bool shared; // mapped from the file at its base, otherwise relocated in a private mapping.
+  micolisp_number_cell *numbers;
+  size_t numberslength;
+  micolisp_symbol *symbols;
+  size_t symbolslength;
+  micolisp_cons *conses;
+  size_t conseslength;
+  micolisp_symbol **resolved; // symbols of the machine which take the place of the symbols of the segment.
+  struct micolisp_segment *next;
+} micolisp_segment;
+
 typedef struct micolisp_machine { 
   micolisp_memory memory;
   micolisp_scope *scope;
   hashset symbol;
+  micolisp_free_stack freestack;
+  size_t freebudget; // objects released per step, 0 means release everything at once.
+  micolisp_arena arena;
+  micolisp_arena_mode arenamode;
+  // regions back only the nodes of the arena. the heap grows by cgcmemnode chains,
+  // which allocate their own memory, so neither option applies to the heap.
+  size_t regionsize; // bytes of an arena region reserved with mmap, 0 means arena nodes are malloced.
+  bool hugepage; // advise huge pages on arena regions.
+  bool numberreuse; // write arithmetic results into temporary numbers.
+  struct micolisp_cons *resultargs; // arguments of the call whose result var binds in place of resultnumber.
+  micolisp_number *resultnumber; // number bound only to the name which var rebinds, see __micolisp_var.
+  size_t printprecision; // digits after the point of printed numbers, 0 means the shortest digits which are read back.
+  bool scriptcache; // keep read forms of scripts as binaries, see micolisp_read_script. it is off by default.
+  char *cachedirectory; // directory of the script caches, NULL means next to the scripts.
+  struct micolisp_machine *origin; // machine whose objects are shared, see micolisp_clone.
+  size_t clones; // open clones of this machine.
+  micolisp_segment *segments; // read-only heaps mapped from files, see micolisp_attach_segment.
+  micolisp_memory_account account;
+  micolisp_arena_node *strings;
+  size_t symbollength; // symbols in the symbol table.
+  char *freestrings[MICOLISP_STRING_CLASS_LENGTH]; // released names by words, linked by their prefix.
+  uint64_t pausetarget; // nanoseconds per collection slice, 0 means no limit.
+  micolisp_pause pause; // slices taken while pausetarget is set.
+  micolisp_pool pool;
 } micolisp_machine;
 
 typedef enum micolisp_error_type {
@@ -112,6 +260,7 @@ typedef enum micolisp_error_type {
   MICOLISP_TYPE_ERROR,
   MICOLISP_VALUE_ERROR,
   MICOLISP_SYNTAX_ERROR,
+  MICOLISP_MEMORY_ERROR,
 } micolisp_error_type;
 
 typedef struct micolisp_error_info { 
@@ -155,6 +304,7 @@ extern micolisp_cons *micolisp_quote (void*, micolisp_machine*);
 // cons 
 
 extern micolisp_cons *micolisp_allocate_cons (void*, void*, micolisp_machine*);
+extern int micolisp_linearize (void*, micolisp_machine*, void**);
 extern int micolisp_cons_set (void*, micolisp_cons_whence, micolisp_cons*, micolisp_machine*);
 extern int micolisp_cons_get (micolisp_cons_whence, micolisp_cons*, void**);
 extern micolisp_cons_reference *micolisp_cons_get_reference (micolisp_cons_whence, micolisp_cons*, micolisp_machine*);
@@ -178,14 +328,47 @@ extern int micolisp_reference_get (void*, micolisp_machine*, void**);
 // machine 
 
 extern bool micolisp_typep (micolisp_memory_type, void*, micolisp_machine*);
+extern bool micolisp_sharedp (void*, micolisp_machine*);
 extern void *micolisp_allocate (micolisp_memory_type, size_t, micolisp_machine*);
 extern int micolisp_increase (void*, micolisp_machine*);
 extern int micolisp_decrease (void*, micolisp_machine*);
+extern int micolisp_collect_step (size_t, micolisp_machine*);
+extern int micolisp_collect (micolisp_machine*);
+
+// arena 
+
+extern bool micolisp_arenap (void*, micolisp_machine*);
+extern int micolisp_arena_begin (micolisp_machine*);
+extern int micolisp_arena_end (micolisp_machine*);
+
+// port 
+
+#define MICOLISP_PORT_BUFFER_SIZE (64 * 1024)
+
+typedef struct micolisp_port {
+  FILE *file; // the buffer is written to the file when it is full, NULL means the buffer grows.
+  char *sequence;
+  size_t length;
+  size_t capacity;
+  bool owned; // the sequence is freed by micolisp_port_close.
+} micolisp_port;
+
+extern int micolisp_port_open_file (FILE*, micolisp_port*);
+extern void micolisp_port_open_buffer (micolisp_port*);
+extern int micolisp_port_write (char*, size_t, micolisp_port*);
+extern int micolisp_port_flush (micolisp_port*);
+extern int micolisp_port_close (micolisp_port*);
 
 // lisp 
 
+#define MICOLISP_NUMBER_FORMAT_LENGTH 64
+#define MICOLISP_NUMBER_PRECISION_MAX 32
+
+extern size_t micolisp_format_number (micolisp_number, size_t, char*);
 extern int micolisp_print (void*, FILE*, micolisp_machine*);
 extern int micolisp_println (void*, FILE*, micolisp_machine*);
+extern int micolisp_print_port (void*, micolisp_port*, micolisp_machine*);
+extern int micolisp_print_to_buffer (void*, micolisp_machine*, char**, size_t*);
 
 // read 
 
@@ -195,18 +378,85 @@ extern int micolisp_println (void*, FILE*, micolisp_machine*);
 #define MICOLISP_READ_CLOSE_PAREN 3 
 #define MICOLISP_READ_DOT 4
 
+// the reader classifies characters as chosen when micolisp.c is compiled.
+// the loop scans lists of characters byte by byte, as the reader did before the table, so the others are measured against it.
+#define MICOLISP_CLASSIFY_LOOP 0
+#define MICOLISP_CLASSIFY_TABLE 1
+#define MICOLISP_CLASSIFY_SSE2 2
+#ifndef MICOLISP_CLASSIFY
+#ifdef __SSE2__
+#define MICOLISP_CLASSIFY MICOLISP_CLASSIFY_SSE2
+#else
+#define MICOLISP_CLASSIFY MICOLISP_CLASSIFY_TABLE
+#endif
+#endif
+
 extern int micolisp_read (FILE*, micolisp_machine*, void**);
+extern int micolisp_read_buffer (char*, size_t, size_t*, micolisp_machine*, void**);
+extern int micolisp_read_file (FILE*, micolisp_machine*, void**);
+extern int micolisp_read_buffer_parallel (char*, size_t, size_t, micolisp_machine*, void**);
+extern int micolisp_read_file_parallel (FILE*, size_t, micolisp_machine*, void**);
+
+typedef struct micolisp_reader_frame {
+  size_t start; // index of the first value of the frame.
+  int type;
+} micolisp_reader_frame;
+
+typedef struct micolisp_reader {
+  int state;
+  char *buffer; // characters of the token or the string being read.
+  size_t length;
+  size_t capacity;
+  void **values; // completed forms, and values of the open lists.
+  size_t valueslength;
+  size_t valuescapacity;
+  micolisp_reader_frame *frames; // open lists and quotes.
+  size_t frameslength;
+  size_t framescapacity;
+} micolisp_reader;
+
+extern void micolisp_reader_init (micolisp_reader*);
+extern int micolisp_reader_feed (char*, size_t, micolisp_reader*, micolisp_machine*, void**);
+extern int micolisp_reader_finish (micolisp_reader*, micolisp_machine*, void**);
+extern void micolisp_reader_close (micolisp_reader*, micolisp_machine*);
 
 // eval
 
 extern int micolisp_eval (void*, micolisp_machine*, void**);
+extern int micolisp_eval_string (char*, size_t, micolisp_machine*, void**);
+extern int micolisp_eval_string0 (char*, micolisp_machine*, void**);
+extern int micolisp_eval_string_all (char*, size_t, micolisp_machine*, void**);
+extern int micolisp_eval_string_all0 (char*, micolisp_machine*, void**);
 
 // repl 
 
 extern int micolisp_repl (FILE*, FILE*, FILE*, micolisp_machine*);
 
+// image 
+
+extern int micolisp_save_image (FILE*, micolisp_machine*);
+extern int micolisp_load_image (FILE*, micolisp_machine*);
+
+// binary 
+
+extern int micolisp_write_binary (void*, FILE*, micolisp_machine*);
+extern int micolisp_read_binary (FILE*, micolisp_machine*, void**);
+
+// script 
+
+extern int micolisp_read_script (char*, micolisp_machine*, void**);
+extern int micolisp_run_script (char*, FILE*, FILE*, micolisp_machine*);
+
 // micolisp 
 
 extern int micolisp_open (micolisp_machine*);
+// a clone shares the objects of its origin without copy, and they are read-only in the clone.
+// set on a name of the origin binds the new value in the root of the clone,
+// but a cons of the origin is not copied on write, so micolisp_cons_set fails on it with MICOLISP_VALUE_ERROR.
+// a clone which modifies a list of the origin binds its own copy of the list first.
+extern int micolisp_clone (micolisp_machine*, micolisp_machine*);
+extern int micolisp_save_segment (FILE*, void*, micolisp_machine*);
+extern int micolisp_attach_segment (FILE*, char*, micolisp_machine*);
+extern bool micolisp_segmentp (void*, micolisp_machine*);
 extern int micolisp_load_library (micolisp_machine*);
 extern int micolisp_close (micolisp_machine*);
@@ -1,6 +1,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <utime.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "micolisp.h"
 
 #define TEST(form)\
@@ -55,6 +60,49 @@ static void test_micolisp_allocate (){
     TEST(micolisp_decrease(symb2, &machine) == 0);
     TEST(micolisp_decrease(symc2, &machine) == 0);
   }
+  // allocate long or anagram symbol.
+  {
+    char name[256];
+    for (size_t index = 0; index < sizeof(name) -1; index++){ name[index] = 'a' + index % 26; }
+    name[sizeof(name) -1] = '\0';
+    micolisp_symbol *symlong = micolisp_allocate_symbol0(name, &machine);
+    micolisp_symbol *symlong2 = micolisp_allocate_symbol0(name, &machine);
+    micolisp_symbol *symab = micolisp_allocate_symbol0("ab", &machine);
+    micolisp_symbol *symba = micolisp_allocate_symbol0("ba", &machine);
+    TEST(symlong != NULL);
+    TEST(symlong == symlong2);
+    TEST(symlong->length == sizeof(name) -1);
+    TEST(symab != NULL);
+    TEST(symba != NULL);
+    TEST(symab != symba);
+    TEST(symab->hash != symba->hash);
+    TEST(micolisp_decrease(symlong, &machine) == 0);
+    TEST(micolisp_decrease(symlong2, &machine) == 0);
+    TEST(micolisp_decrease(symab, &machine) == 0);
+    TEST(micolisp_decrease(symba, &machine) == 0);
+  }
+  // names of released symbols are reused by names of the same size.
+  {
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("released-name-1", &machine);
+    TEST(symbol != NULL);
+    char *characters = symbol->characters;
+    TEST(micolisp_decrease(symbol, &machine) == 0);
+    TEST(micolisp_collect(&machine) == 0);
+    micolisp_symbol *shorter = micolisp_allocate_symbol0("name", &machine);
+    TEST(shorter != NULL);
+    TEST(shorter->characters != characters);
+    micolisp_symbol *reused = micolisp_allocate_symbol0("released-name-2", &machine);
+    TEST(reused != NULL);
+    TEST(reused->characters == characters);
+    TEST(reused->length == 15);
+    TEST(reused->characters[14] == '2');
+    micolisp_symbol *fresh = micolisp_allocate_symbol0("released-name-3", &machine);
+    TEST(fresh != NULL);
+    TEST(fresh->characters != characters);
+    TEST(micolisp_decrease(shorter, &machine) == 0);
+    TEST(micolisp_decrease(reused, &machine) == 0);
+    TEST(micolisp_decrease(fresh, &machine) == 0);
+  }
   // allocate c function.
   {
     micolisp_c_function *function = micolisp_allocate_c_function(MICOLISP_FUNCTION, NULL, &machine);
@@ -891,6 +939,1802 @@ static void test_micolisp_eval (){
   TEST(micolisp_close(&machine) == 0);
 }
 
+static double benchmark_micolisp_release (size_t length){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  char *source = malloc(length * 2 + 2);
+  TEST(source != NULL);
+  source[0] = '(';
+  for (size_t index = 0; index < length; index++){
+    source[index * 2 + 1] = 't';
+    source[index * 2 + 2] = ' ';
+  }
+  source[length * 2 + 1] = ')';
+  size_t index = 0;
+  void *list;
+  TEST(micolisp_read_buffer(source, length * 2 + 2, &index, &machine, &list) == 0);
+  clock_t start = clock();
+  TEST(micolisp_decrease(list, &machine) == 0);
+  TEST(micolisp_collect(&machine) == 0);
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  TEST(machine.freestack.length == 0);
+  TEST(micolisp_close(&machine) == 0);
+  free(source);
+  return seconds;
+}
+
+static void test_micolisp_collect (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  machine.freebudget = 4;
+  // release a large list step by step.
+  {
+    size_t reserved = 0;
+    for (size_t round = 0; round < 2; round++){
+      micolisp_cons *list = NULL;
+      for (size_t index = 0; index < 1000; index++){
+        micolisp_number *number = micolisp_allocate_number(&machine);
+        TEST(number != NULL);
+        *number = index;
+        micolisp_cons *cons = micolisp_allocate_cons(number, list, &machine);
+        TEST(cons != NULL);
+        TEST(micolisp_decrease(number, &machine) == 0);
+        TEST(micolisp_decrease(list, &machine) == 0);
+        list = cons;
+      }
+      TEST(micolisp_decrease(list, &machine) == 0);
+      TEST(0 < machine.freestack.length);
+      TEST(micolisp_collect_step(4, &machine) == 0);
+      TEST(0 < machine.freestack.length);
+      TEST(micolisp_collect(&machine) == 0);
+      TEST(machine.freestack.length == 0);
+      // the released cells are reused by the next list, so the heap does not grow.
+      if (round == 0){ reserved = machine.account.total.reserved; }
+      else { TEST(machine.account.total.reserved == reserved); }
+    }
+  }
+  // a long list is released in linear time.
+  {
+    double seconds1 = benchmark_micolisp_release(10000);
+    double seconds2 = benchmark_micolisp_release(40000);
+    printf("release of lists: %.3fs for 10000 conses, %.3fs for 40000 conses.\n", seconds1, seconds2);
+    TEST(seconds2 < seconds1 * 8 + 0.05);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_arena (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  machine.arenamode = MICOLISP_ARENA_READ;
+  // values escaped to the scope are promoted.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var x '(1 2 3))", &machine, &value) == 0);
+    TEST(machine.arena.depth == 0);
+    TEST(machine.arena.cons == NULL);
+    TEST(micolisp_typep(MICOLISP_CONS, value, &machine));
+    TEST(micolisp_decrease(value, &machine) == 0);
+    void *valueevaluated;
+    TEST(micolisp_eval_string0("(car (cdr x))", &machine, &valueevaluated) == 0);
+    void *valuedereferenced;
+    TEST(micolisp_reference_get(valueevaluated, &machine, &valuedereferenced) == 0);
+    TEST(micolisp_typep(MICOLISP_NUMBER, valuedereferenced, &machine));
+    TEST(*(micolisp_number*)valuedereferenced == 2);
+    TEST(micolisp_decrease(valueevaluated, &machine) == 0);
+  }
+  // read form is allocated in the arena.
+  {
+    FILE *file = fopen("test/eval2.lisp", "r");
+    TEST(file != NULL);
+    TEST(micolisp_arena_begin(&machine) == 0);
+    void *form;
+    TEST(micolisp_read(file, &machine, &form) == 0);
+    TEST(micolisp_arenap(form, &machine));
+    void *formevaluated;
+    TEST(micolisp_eval(form, &machine, &formevaluated) == 0);
+    TEST(!micolisp_arenap(formevaluated, &machine));
+    TEST(*(micolisp_number*)formevaluated == 6);
+    TEST(micolisp_decrease(form, &machine) == 0);
+    TEST(micolisp_arena_end(&machine) == 0);
+    TEST(!micolisp_arenap(form, &machine));
+    TEST(micolisp_decrease(formevaluated, &machine) == 0);
+    TEST(fclose(file) == 0);
+  }
+  machine.arenamode = MICOLISP_ARENA_EVAL;
+  // evaluated value is promoted.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(list 1 (+ 2 3))", &machine, &value) == 0);
+    TEST(micolisp_typep(MICOLISP_CONS, value, &machine));
+    TEST(*(micolisp_number*)((micolisp_cons*)value)->car == 1);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // addresses are found in every node of the arena.
+  {
+    TEST(micolisp_arena_begin(&machine) == 0);
+    micolisp_cons *first = micolisp_allocate_cons(NULL, NULL, &machine);
+    micolisp_cons *last = first;
+    for (size_t index = 0; index < 10000; index++){
+      last = micolisp_allocate_cons(NULL, NULL, &machine);
+      TEST(last != NULL);
+    }
+    micolisp_number *number = micolisp_allocate_number(&machine);
+    TEST(number != NULL);
+    TEST(machine.arena.cons->next != NULL);
+    TEST(micolisp_arenap(first, &machine));
+    TEST(micolisp_arenap(last, &machine));
+    TEST(micolisp_arenap(number, &machine));
+    TEST(micolisp_typep(MICOLISP_CONS, first, &machine));
+    TEST(micolisp_typep(MICOLISP_NUMBER, number, &machine));
+    TEST(!micolisp_typep(MICOLISP_NUMBER, last, &machine));
+    TEST(!micolisp_arenap(&machine, &machine));
+    TEST(micolisp_arena_end(&machine) == 0);
+    TEST(!micolisp_arenap(first, &machine));
+    TEST(!micolisp_arenap(last, &machine));
+    TEST(machine.arena.rangeslength == 0);
+  }
+  // the arena is ended when the repl or a script stops by an error.
+  {
+    FILE *input = tmpfile();
+    FILE *output = tmpfile();
+    TEST(input != NULL && output != NULL);
+    fputs("(list 1 2)\n(car 1)\n(list 3 4)\n", input);
+    rewind(input);
+    TEST(micolisp_repl(input, output, output, &machine) == 1);
+    TEST(machine.arena.depth == 0);
+    TEST(machine.arena.externalslength == 0);
+    rewind(input);
+    fputs("(list 1 2))", input);
+    rewind(input);
+    TEST(micolisp_repl(input, output, output, &machine) == 1);
+    TEST(machine.arena.depth == 0);
+    char directory[] = "/tmp/micolisp-arena-XXXXXX";
+    TEST(mkdtemp(directory) != NULL);
+    char path[64];
+    snprintf(path, sizeof(path), "%s/script.lisp", directory);
+    FILE *script = fopen(path, "w");
+    TEST(script != NULL);
+    fputs("(list 1 2)\n(car 1)\n(list 3 4)\n", script);
+    TEST(fclose(script) == 0);
+    TEST(micolisp_run_script(path, output, output, &machine) == 1);
+    TEST(machine.arena.depth == 0);
+    TEST(machine.arena.externalslength == 0);
+    TEST(remove(path) == 0);
+    TEST(remove(directory) == 0);
+    TEST(fclose(input) == 0);
+    TEST(fclose(output) == 0);
+  }
+  // a promotion which failed for memory leaves no marks, so the list is promoted later.
+  {
+    machine.arenamode = MICOLISP_ARENA_READ;
+    char source[4020];
+    size_t size = sprintf(source, "(var promoted '(");
+    for (size_t index = 0; index < 2000; index++){
+      size += sprintf(source + size, " 7");
+    }
+    size += sprintf(source + size, "))");
+    TEST(micolisp_arena_begin(&machine) == 0);
+    void *form;
+    size_t index = 0;
+    TEST(micolisp_read_buffer(source, size, &index, &machine, &form) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_arenap(form, &machine));
+    // the free conses but a thousand are taken, so the copy runs out of conses part way.
+    machine.arenamode = MICOLISP_ARENA_NONE;
+    machine.account.limits[MICOLISP_CONS] = machine.account.counts[MICOLISP_CONS].reserved;
+    size_t conseslength = 0;
+    micolisp_cons **conses = NULL;
+    while (true){
+      if ((conseslength & 1023) == 0){
+        conses = realloc(conses, (conseslength + 1024) * sizeof(micolisp_cons*));
+        TEST(conses != NULL);
+      }
+      conses[conseslength] = micolisp_allocate_cons(NULL, NULL, &machine);
+      if (conses[conseslength] == NULL){ break; }
+      conseslength += 1;
+    }
+    for (size_t count = 0; count < 1000 && 0 < conseslength; count++){
+      conseslength -= 1;
+      TEST(micolisp_decrease(conses[conseslength], &machine) == 0);
+    }
+    machine.arenamode = MICOLISP_ARENA_READ;
+    void *value;
+    TEST(micolisp_eval(form, &machine, &value) != 0);
+    TEST(micolisp_error.code == MICOLISP_MEMORY_ERROR);
+    for (size_t index = 0; index < conseslength; index++){
+      TEST(micolisp_decrease(conses[index], &machine) == 0);
+    }
+    free(conses);
+    machine.account.limits[MICOLISP_CONS] = 0;
+    TEST(micolisp_eval(form, &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_decrease(form, &machine) == 0);
+    TEST(micolisp_arena_end(&machine) == 0);
+    TEST(micolisp_eval_string0("(car (cdr (cdr promoted)))", &machine, &value) == 0);
+    void *valuedereferenced;
+    TEST(micolisp_reference_get(value, &machine, &valuedereferenced) == 0);
+    TEST(*(micolisp_number*)valuedereferenced == 7);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_image (){
+  FILE *file = tmpfile();
+  TEST(file != NULL);
+  // save the library and user definitions.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    void *value;
+    TEST(micolisp_eval_string0("(function square (x) (* x x))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var numbers '(1 2 3))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var first car)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_save_image(file, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  rewind(file);
+  // load them without the library.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_image(file, &machine) == 0);
+    void *value;
+    TEST(micolisp_eval_string0("(square 4)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 16);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(first (cdr numbers))", &machine, &value) == 0);
+    void *valuedereferenced;
+    TEST(micolisp_reference_get(value, &machine, &valuedereferenced) == 0);
+    TEST(*(micolisp_number*)valuedereferenced == 2);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(when (not nil) (length numbers))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 3);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  // broken image is not loaded.
+  {
+    rewind(file);
+    TEST(fputc('x', file) != EOF);
+    rewind(file);
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_image(file, &machine) != 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  TEST(fclose(file) == 0);
+}
+
+static void benchmark_micolisp_image (){
+  size_t count = 400;
+  size_t size = count * 48;
+  char *source = malloc(size);
+  TEST(source != NULL);
+  size_t length = 0;
+  for (size_t index = 0; index < count; index++){
+    length += snprintf(source + length, size - length, "(var global%zu '(%zu %zu %zu))\n", index, index, index, index);
+  }
+  FILE *file = tmpfile();
+  TEST(file != NULL);
+  micolisp_machine machine;
+  void *value;
+  clock_t start = clock();
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  TEST(micolisp_eval_string_all0(source, &machine, &value) == 0);
+  double seconds1 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_save_image(file, &machine) == 0);
+  TEST(micolisp_close(&machine) == 0);
+  rewind(file);
+  start = clock();
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_image(file, &machine) == 0);
+  double seconds2 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("startup with %zu globals: %.3fs from source, %.3fs from image.\n", count, seconds1, seconds2);
+  TEST(micolisp_eval_string0("(car (cdr global399))", &machine, &value) == 0);
+  void *valuedereferenced;
+  TEST(micolisp_reference_get(value, &machine, &valuedereferenced) == 0);
+  TEST(*(micolisp_number*)valuedereferenced == 399);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  // loading the image skips reading and evaluation, so it is faster than the source.
+  TEST(seconds2 < seconds1);
+  TEST(micolisp_close(&machine) == 0);
+  TEST(fclose(file) == 0);
+  free(source);
+}
+
+static void test_micolisp_account (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  TEST(0 < machine.account.counts[MICOLISP_SYMBOL].allocated);
+  TEST(0 < machine.account.total.reserved);
+  TEST(machine.account.total.reserved <= machine.account.total.peak);
+  // allocated counts only grow, and live counts go back when the objects are released.
+  {
+    size_t allocated = machine.account.counts[MICOLISP_NUMBER].allocated;
+    size_t live = machine.account.counts[MICOLISP_NUMBER].live;
+    size_t livebytes = machine.account.total.livebytes;
+    void *value;
+    TEST(micolisp_eval_string0("(list 1.5 2.5 3.5)", &machine, &value) == 0);
+    TEST(machine.account.counts[MICOLISP_NUMBER].allocated - allocated >= 3);
+    TEST(machine.account.counts[MICOLISP_NUMBER].live - live == 3);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_collect(&machine) == 0);
+    TEST(machine.account.counts[MICOLISP_NUMBER].live == live);
+    TEST(machine.account.total.livebytes == livebytes);
+    TEST(machine.account.counts[MICOLISP_NUMBER].allocated - allocated >= 3);
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("live-symbol", &machine);
+    TEST(symbol != NULL);
+    TEST(machine.account.counts[MICOLISP_SYMBOL].live == machine.symbollength);
+    TEST(micolisp_decrease(symbol, &machine) == 0);
+    TEST(micolisp_collect(&machine) == 0);
+    TEST(machine.account.counts[MICOLISP_SYMBOL].live == machine.symbollength);
+    char source[2001];
+    for (size_t index = 0; index < 1000; index++){
+      source[index * 2] = ' ';
+      source[index * 2 + 1] = 't';
+    }
+    source[0] = '(';
+    source[2000] = ')';
+    machine.arenamode = MICOLISP_ARENA_READ;
+    TEST(micolisp_arena_begin(&machine) == 0);
+    size_t conses = machine.account.counts[MICOLISP_CONS].live;
+    size_t index = 0;
+    TEST(micolisp_read_buffer(source, sizeof(source), &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_arenap(value, &machine));
+    TEST(machine.account.counts[MICOLISP_CONS].live - conses == 1000);
+    TEST(micolisp_arena_end(&machine) == 0);
+    TEST(machine.account.counts[MICOLISP_CONS].live == conses);
+    machine.arenamode = MICOLISP_ARENA_NONE;
+  }
+  // per-type limit is enforced.
+  {
+    machine.account.limits[MICOLISP_NUMBER] = machine.account.counts[MICOLISP_NUMBER].reserved + 4096;
+    micolisp_number *numbers[4096];
+    size_t length = 0;
+    while (length < 4096){
+      numbers[length] = micolisp_allocate_number(&machine);
+      if (numbers[length] == NULL){ break; }
+      length += 1;
+    }
+    TEST(length < 4096);
+    TEST(micolisp_error.code == MICOLISP_MEMORY_ERROR);
+    TEST(machine.account.counts[MICOLISP_NUMBER].reserved <= machine.account.limits[MICOLISP_NUMBER]);
+    // released objects are reused under the limit.
+    TEST(micolisp_decrease(numbers[0], &machine) == 0);
+    numbers[0] = micolisp_allocate_number(&machine);
+    TEST(numbers[0] != NULL);
+    for (size_t index = 0; index < length; index++){
+      TEST(micolisp_decrease(numbers[index], &machine) == 0);
+    }
+    machine.account.limits[MICOLISP_NUMBER] = 0;
+  }
+  // total limit is enforced.
+  {
+    machine.account.limit = machine.account.total.reserved;
+    micolisp_cons *list = NULL;
+    for (size_t index = 0; index < 100000; index++){
+      micolisp_cons *cons = micolisp_allocate_cons(NULL, list, &machine);
+      if (cons == NULL){ break; }
+      TEST(micolisp_decrease(list, &machine) == 0);
+      list = cons;
+    }
+    TEST(micolisp_error.code == MICOLISP_MEMORY_ERROR);
+    TEST(machine.account.total.reserved <= machine.account.limit);
+    TEST(micolisp_decrease(list, &machine) == 0);
+    machine.account.limit = 0;
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_pause (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  // release is sliced by the pause target.
+  {
+    micolisp_cons *list = NULL;
+    for (size_t index = 0; index < 1000; index++){
+      micolisp_cons *cons = micolisp_allocate_cons(NULL, list, &machine);
+      TEST(cons != NULL);
+      TEST(micolisp_decrease(list, &machine) == 0);
+      list = cons;
+    }
+    machine.pausetarget = 1;
+    TEST(micolisp_decrease(list, &machine) == 0);
+    TEST(0 < machine.freestack.length);
+    TEST(0 < machine.pause.count);
+    TEST(machine.pause.last <= machine.pause.max);
+    TEST(micolisp_collect(&machine) == 0);
+    TEST(machine.freestack.length == 0);
+  }
+  // slices stay near the pause target, however large the released list is.
+  {
+    size_t length = 5000;
+    char *source = malloc(length * 8 + 2);
+    TEST(source != NULL);
+    size_t size = 0;
+    source[size++] = '(';
+    for (size_t index = 0; index < length; index++){
+      size += sprintf(source + size, "(%zu) ", index % 1000);
+    }
+    source[size++] = ')';
+    size_t index = 0;
+    void *list;
+    TEST(micolisp_read_buffer(source, size, &index, &machine, &list) == 0);
+    free(source);
+    machine.pausetarget = 200000;
+    machine.pause = (micolisp_pause){ 0, 0, 0, 0 };
+    TEST(micolisp_decrease(list, &machine) == 0);
+    while (0 < machine.freestack.length){
+      TEST(micolisp_collect_step(0, &machine) == 0);
+    }
+    printf("pauses of releasing %zu lists: %llu slices, %lluus at most, %lluus on average for the target of %lluus.\n", length, (unsigned long long)machine.pause.count, (unsigned long long)machine.pause.max / 1000, (unsigned long long)(machine.pause.total / machine.pause.count / 1000), (unsigned long long)machine.pausetarget / 1000);
+    TEST(1 < machine.pause.count);
+    TEST(machine.pause.max < machine.pausetarget * 3);
+    machine.pausetarget = 0;
+  }
+  // a value stored between slices is kept, because the slices apply decreases and do not trace.
+  {
+    size_t length = 1000;
+    char *source = malloc(length * 8 + 2);
+    TEST(source != NULL);
+    size_t size = 0;
+    source[size++] = '(';
+    for (size_t index = 0; index < length; index++){
+      size += sprintf(source + size, "(%zu) ", index);
+    }
+    source[size++] = ')';
+    size_t index = 0;
+    micolisp_cons *list;
+    TEST(micolisp_read_buffer(source, size, &index, &machine, (void**)&list) == 0);
+    free(source);
+    micolisp_cons *cons = list;
+    for (size_t count = 0; count < length / 2; count++){ cons = cons->cdr; }
+    micolisp_cons *kept = cons->car;
+    micolisp_cons *holder = micolisp_allocate_cons(NULL, NULL, &machine);
+    TEST(holder != NULL);
+    machine.freebudget = 4;
+    TEST(micolisp_decrease(list, &machine) == 0);
+    TEST(0 < machine.freestack.length);
+    TEST(micolisp_cons_set(kept, MICOLISP_CONS_CAR, holder, &machine) == 0);
+    TEST(micolisp_collect(&machine) == 0);
+    TEST(holder->car == kept);
+    TEST(*(micolisp_number*)kept->car == length / 2);
+    TEST(micolisp_decrease(holder, &machine) == 0);
+    TEST(micolisp_collect(&machine) == 0);
+    machine.freebudget = 0;
+  }
+  // a circular list is released across slices.
+  {
+    size_t length = 300;
+    char source[length * 2 + 2];
+    source[0] = '(';
+    for (size_t index = 0; index < length; index++){
+      source[index * 2 + 1] = 't';
+      source[index * 2 + 2] = ' ';
+    }
+    source[length * 2 + 1] = ')';
+    size_t index = 0;
+    micolisp_cons *list;
+    TEST(micolisp_read_buffer(source, sizeof(source), &index, &machine, (void**)&list) == 0);
+    micolisp_cons *last = list;
+    while (last->cdr != NULL){ last = last->cdr; }
+    TEST(micolisp_cons_set(list, MICOLISP_CONS_CDR, last, &machine) == 0);
+    machine.pausetarget = 1;
+    TEST(micolisp_decrease(list, &machine) == 0);
+    while (0 < machine.freestack.length){
+      TEST(micolisp_collect_step(0, &machine) == 0);
+    }
+    machine.pausetarget = 0;
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_pool (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  void *value;
+  // frames of returned calls are recycled.
+  {
+    TEST(micolisp_eval_string0("(function add (a b) (+ a b))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(add 1 2)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 3);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    micolisp_scope *scope = machine.pool.scopes;
+    TEST(scope != NULL);
+    TEST(micolisp_eval_string0("(add 3 4)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 7);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(machine.pool.scopes == scope);
+  }
+  // stretched entries are recycled.
+  {
+    TEST(micolisp_eval_string0("(function sum (a b c d e f g h i j k l) (+ a b c d e f g h i j k l))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    for (size_t index = 0; index < 3; index++){
+      TEST(micolisp_eval_string0("(sum 1 2 3 4 5 6 7 8 9 10 11 12)", &machine, &value) == 0);
+      TEST(*(micolisp_number*)value == 78);
+      TEST(micolisp_decrease(value, &machine) == 0);
+    }
+    TEST(machine.pool.entries[0] != NULL);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_region (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  machine.arenamode = MICOLISP_ARENA_READ;
+  machine.regionsize = 64 * 1024 * 1024;
+  machine.hugepage = true;
+  size_t reserved = machine.account.counts[MICOLISP_CONS].reserved;
+  // read forms are allocated in a region, and the region is kept after the arena.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var x '(1 2 3))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    micolisp_arena_node *region = machine.arena.cons;
+    TEST(region != NULL);
+    TEST(machine.regionsize <= region->mapped);
+    TEST(region->committed == 0);
+    TEST(region->next == NULL);
+    TEST(machine.account.counts[MICOLISP_CONS].reserved == reserved);
+    TEST(micolisp_eval_string0("(reduce + x)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 6);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(machine.arena.cons == region);
+    TEST(region->committed == 0);
+  }
+  // committed bytes are accounted while the arena is active.
+  {
+    machine.arenamode = MICOLISP_ARENA_EVAL;
+    TEST(micolisp_arena_begin(&machine) == 0);
+    micolisp_cons *cons = micolisp_allocate_cons(MICOLISP_NIL, NULL, &machine);
+    TEST(cons != NULL);
+    TEST(micolisp_arenap(cons, &machine));
+    TEST(0 < machine.arena.cons->committed);
+    TEST(machine.account.counts[MICOLISP_CONS].reserved == reserved + machine.arena.cons->committed);
+    TEST(micolisp_arena_end(&machine) == 0);
+    TEST(machine.account.counts[MICOLISP_CONS].reserved == reserved);
+  }
+  // the heap does not grow by regions, so outside the arena no region is made.
+  {
+    machine.arenamode = MICOLISP_ARENA_NONE;
+    micolisp_arena_node *region = machine.arena.cons;
+    micolisp_arena_node *numberregion = machine.arena.number;
+    size_t rangeslength = machine.arena.rangeslength;
+    micolisp_cons *list = NULL;
+    for (size_t index = 0; index < 1000; index++){
+      micolisp_cons *cons = micolisp_allocate_cons(MICOLISP_NIL, NULL, &machine);
+      TEST(cons != NULL);
+      TEST(!micolisp_arenap(cons, &machine));
+      cons->cdr = list;
+      list = cons;
+    }
+    TEST(machine.arena.cons == region);
+    TEST(machine.arena.number == numberregion);
+    TEST(machine.arena.rangeslength == rangeslength);
+    TEST(micolisp_decrease(list, &machine) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_weak_symbol (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  // held symbols are shared.
+  {
+    micolisp_symbol *symbol1 = micolisp_allocate_symbol0("weak", &machine);
+    TEST(symbol1 != NULL);
+    micolisp_symbol *symbol2 = micolisp_allocate_symbol0("weak", &machine);
+    TEST(symbol1 == symbol2);
+    TEST(micolisp_decrease(symbol1, &machine) == 0);
+    TEST(micolisp_decrease(symbol2, &machine) == 0);
+  }
+  // released symbols leave the table, and memory stays flat under churn.
+  {
+    size_t symbollength = machine.symbollength;
+    size_t length = 0;
+    size_t reserved = 0;
+    for (size_t index = 0; index < 20000; index++){
+      char name[32];
+      sprintf(name, "key-%zu", index);
+      micolisp_symbol *symbol = micolisp_allocate_symbol0(name, &machine);
+      TEST(symbol != NULL);
+      TEST(machine.symbollength == symbollength + 1);
+      TEST(micolisp_decrease(symbol, &machine) == 0);
+      TEST(machine.symbollength == symbollength);
+      if (index == 1000){
+        length = machine.symbol.length;
+        reserved = machine.account.counts[MICOLISP_SYMBOL].reserved;
+      }
+    }
+    TEST(machine.symbol.length == length);
+    TEST(machine.account.counts[MICOLISP_SYMBOL].reserved == reserved);
+  }
+  // the table shrinks when its load drops.
+  {
+    static micolisp_symbol *symbols[4096];
+    for (size_t index = 0; index < 4096; index++){
+      char name[32];
+      sprintf(name, "many-%zu", index);
+      symbols[index] = micolisp_allocate_symbol0(name, &machine);
+      TEST(symbols[index] != NULL);
+    }
+    size_t length = machine.symbol.length;
+    for (size_t index = 0; index < 4096; index++){
+      TEST(micolisp_decrease(symbols[index], &machine) == 0);
+    }
+    micolisp_symbol *symbol = micolisp_allocate_symbol0("many-0", &machine);
+    TEST(symbol != NULL);
+    TEST(machine.symbol.length < length);
+    TEST(micolisp_decrease(symbol, &machine) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_list_builder (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  // long lists are built in one block.
+  {
+    char source[4096] = "(list";
+    size_t length = 5;
+    for (size_t index = 0; index < 300; index++){
+      length += sprintf(source + length, " %zu", index);
+    }
+    sprintf(source + length, ")");
+    void *value;
+    TEST(micolisp_eval_string0(source, &machine, &value) == 0);
+    size_t index = 0;
+    for (micolisp_cons *cons = value; cons != NULL; cons = cons->cdr, index++){
+      TEST(*(micolisp_number*)cons->car == index);
+      if (cons->cdr != NULL){ TEST(cons->cdr == cons + 1); }
+    }
+    TEST(index == 300);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // a scattered spine is copied into one block.
+  {
+    size_t length = 100;
+    micolisp_number *tail = micolisp_allocate_number(&machine);
+    TEST(tail != NULL);
+    *tail = length;
+    void *list = tail;
+    micolisp_cons *gaps[length];
+    for (size_t index = length; 0 < index; index--){
+      micolisp_number *number = micolisp_allocate_number(&machine);
+      TEST(number != NULL);
+      *number = index - 1;
+      micolisp_cons *cons = micolisp_allocate_cons(number, list, &machine);
+      TEST(cons != NULL);
+      TEST(micolisp_decrease(number, &machine) == 0);
+      TEST(micolisp_decrease(list, &machine) == 0);
+      list = cons;
+      gaps[index - 1] = micolisp_allocate_cons(NULL, NULL, &machine);
+      TEST(gaps[index - 1] != NULL);
+    }
+    void *linearized;
+    TEST(micolisp_linearize(list, &machine, &linearized) == 0);
+    TEST(micolisp_decrease(list, &machine) == 0);
+    for (size_t index = 0; index < length; index++){
+      TEST(micolisp_decrease(gaps[index], &machine) == 0);
+    }
+    size_t index = 0;
+    micolisp_cons *cons = linearized;
+    for (; micolisp_typep(MICOLISP_CONS, cons, &machine); cons = cons->cdr, index++){
+      TEST(*(micolisp_number*)cons->car == index);
+      if (micolisp_typep(MICOLISP_CONS, cons->cdr, &machine)){ TEST(cons->cdr == cons + 1); }
+    }
+    TEST(index == length);
+    TEST(*(micolisp_number*)cons == length);
+    TEST(micolisp_decrease(linearized, &machine) == 0);
+  }
+  // a circular list is not linearized.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var circular (list 1 2 3))", &machine, &value) == 0);
+    micolisp_cons *last = value;
+    while (last->cdr != NULL){ last = last->cdr; }
+    TEST(micolisp_cons_set(value, MICOLISP_CONS_CDR, last, &machine) == 0);
+    void *linearized;
+    TEST(micolisp_linearize(value, &machine, &linearized) != 0);
+    TEST(micolisp_error.code == MICOLISP_VALUE_ERROR);
+    TEST(micolisp_cons_set(NULL, MICOLISP_CONS_CDR, last, &machine) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // dotted lists keep their tail.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var dotted '(1 2 . 3))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(cdr (cdr dotted))", &machine, &value) == 0);
+    void *valuedereferenced;
+    TEST(micolisp_reference_get(value, &machine, &valuedereferenced) == 0);
+    TEST(*(micolisp_number*)valuedereferenced == 3);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // read values are released when the conses of the list could not be allocated,
+  // so the numbers fit again under a limit which leaves no room for leaked ones.
+  {
+    size_t length = 5000;
+    char *source = malloc(length * 8);
+    TEST(source != NULL);
+    size_t size = sprintf(source, "(");
+    for (size_t index = 0; index < length; index++){
+      size += sprintf(source + size, " %zu", index);
+    }
+    size += sprintf(source + size, ")");
+    void *value;
+    size_t index = 0;
+    TEST(micolisp_read_buffer(source, size, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    machine.account.limits[MICOLISP_NUMBER] = machine.account.counts[MICOLISP_NUMBER].reserved;
+    machine.account.limits[MICOLISP_CONS] = machine.account.counts[MICOLISP_CONS].reserved;
+    // the free conses are taken, so the list could not be allocated.
+    size_t conseslength = 0;
+    micolisp_cons **conses = NULL;
+    while (true){
+      if ((conseslength & 1023) == 0){
+        conses = realloc(conses, (conseslength + 1024) * sizeof(micolisp_cons*));
+        TEST(conses != NULL);
+      }
+      conses[conseslength] = micolisp_allocate_cons(NULL, NULL, &machine);
+      if (conses[conseslength] == NULL){ break; }
+      conseslength += 1;
+    }
+    for (size_t count = 0; count < 4; count++){
+      index = 0;
+      TEST(micolisp_read_buffer(source, size, &index, &machine, &value) != MICOLISP_READ_SUCCESS);
+      TEST(micolisp_error.code == MICOLISP_MEMORY_ERROR);
+    }
+    for (size_t index = 0; index < conseslength; index++){
+      TEST(micolisp_decrease(conses[index], &machine) == 0);
+    }
+    free(conses);
+    machine.account.limits[MICOLISP_CONS] = 0;
+    index = 0;
+    TEST(micolisp_read_buffer(source, size, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    machine.account.limits[MICOLISP_NUMBER] = 0;
+    free(source);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static size_t count_number_allocation (char *definition, char *call, bool numberreuse, micolisp_number *resultp){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  machine.numberreuse = numberreuse;
+  void *value;
+  TEST(micolisp_eval_string0(definition, &machine, &value) == 0);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  size_t objects = machine.account.counts[MICOLISP_NUMBER].allocated;
+  TEST(micolisp_eval_string0(call, &machine, &value) == 0);
+  *resultp = *(micolisp_number*)value;
+  TEST(micolisp_decrease(value, &machine) == 0);
+  objects = machine.account.counts[MICOLISP_NUMBER].allocated - objects;
+  TEST(micolisp_close(&machine) == 0);
+  return objects;
+}
+
+static void test_micolisp_number_reuse (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  // temporaries are reused, and bound numbers are kept.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var a 2)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    size_t objects = machine.account.counts[MICOLISP_NUMBER].allocated;
+    TEST(micolisp_eval_string0("(+ (* a 3) (* a 5))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 16);
+    // 3 and 5 are read, the products are allocated, and the sum is written into a product.
+    TEST(machine.account.counts[MICOLISP_NUMBER].allocated - objects == 4);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("a", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 2);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // var writes into the number it rebinds, unless the number is held elsewhere.
+  {
+    void *value;
+    TEST(micolisp_eval_string0("(var b (+ a 1))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var c b)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var b (+ b 1))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 4);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("c", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 3);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var b (+ b 1))", &machine, &value) == 0);
+    void *bound = value;
+    TEST(micolisp_decrease(value, &machine) == 0);
+    size_t objects = machine.account.counts[MICOLISP_NUMBER].allocated;
+    TEST(micolisp_eval_string0("(var b (+ b 1))", &machine, &value) == 0);
+    TEST(value == bound);
+    TEST(*(micolisp_number*)value == 6);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    // 1 is read, and the sum is written into b.
+    TEST(machine.account.counts[MICOLISP_NUMBER].allocated - objects == 1);
+    TEST(micolisp_eval_string0("(var b (- (* b 2) b))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 6);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var b (+ b b))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 12);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+  // allocation counts before and after.
+  {
+    micolisp_number result1;
+    micolisp_number result2;
+    size_t objects1 = count_number_allocation("(function fibonacci (n) (if (<= n 1) n (+ (fibonacci (- n 2)) (fibonacci (- n 1)))))", "(fibonacci 15)", false, &result1);
+    size_t objects2 = count_number_allocation("(function fibonacci (n) (if (<= n 1) n (+ (fibonacci (- n 2)) (fibonacci (- n 1)))))", "(fibonacci 15)", true, &result2);
+    printf("number allocation of (fibonacci 15): %zu without reuse, %zu with reuse.\n", objects1, objects2);
+    TEST(result1 == 610);
+    TEST(result1 == result2);
+    TEST(objects2 < objects1);
+    size_t objects3 = count_number_allocation("(function count-up (n) (progn (var count 0) (while (< count n) (var count (+ count 1))) count))", "(count-up 1000)", false, &result1);
+    size_t objects4 = count_number_allocation("(function count-up (n) (progn (var count 0) (while (< count n) (var count (+ count 1))) count))", "(count-up 1000)", true, &result2);
+    printf("number allocation of (var count (+ count 1)) 1000 times: %zu without reuse, %zu with reuse.\n", objects3, objects4);
+    TEST(result1 == 1000);
+    TEST(result1 == result2);
+    TEST(objects4 < objects3 / 100);
+  }
+}
+
+static void test_micolisp_clone (){
+  micolisp_machine origin;
+  TEST(micolisp_open(&origin) == 0);
+  TEST(micolisp_load_library(&origin) == 0);
+  void *value;
+  TEST(micolisp_eval_string0("(var prelude (list 1 2 3))", &origin, &value) == 0);
+  TEST(micolisp_decrease(value, &origin) == 0);
+  TEST(micolisp_eval_string0("(function total () (reduce + prelude))", &origin, &value) == 0);
+  TEST(micolisp_decrease(value, &origin) == 0);
+  // clones see the origin, and bind their names in their own root.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_clone(&origin, &machine) == 0);
+    TEST(origin.clones == 1);
+    TEST(micolisp_eval_string0("prelude", &machine, &value) == 0);
+    TEST(micolisp_sharedp(value, &machine));
+    TEST(origin.memory.low <= (char*)value && (char*)value < origin.memory.high);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(total)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 6);
+    TEST(!micolisp_sharedp(value, &machine));
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var prelude (list 4 5 6))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(var request 'hello)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(reduce + prelude)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 15);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&origin) != 0);
+    TEST(micolisp_close(&machine) == 0);
+    TEST(origin.clones == 0);
+  }
+  // names of the origin are set in the clone, while conses of the origin are read-only.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_clone(&origin, &machine) == 0);
+    TEST(micolisp_eval_string0("(set (car prelude) 10)", &machine, &value) != 0);
+    TEST(micolisp_error.code == MICOLISP_VALUE_ERROR);
+    TEST(micolisp_eval_string0("(var name 'prelude)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(set (symbol-value 'name) (list 7 8 9))", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(set (car prelude) 10)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(reduce + prelude)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 27);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  // a clone is opened without copying the origin.
+  {
+    size_t count = 1000;
+    clock_t start = clock();
+    for (size_t index = 0; index < count; index++){
+      micolisp_machine machine;
+      TEST(micolisp_clone(&origin, &machine) == 0);
+      TEST(micolisp_close(&machine) == 0);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("clone of the machine with the library: %.1fus on average.\n", seconds / count * 1000000);
+  }
+  // the origin is unchanged by its clones.
+  {
+    TEST(micolisp_eval_string0("(total)", &origin, &value) == 0);
+    TEST(*(micolisp_number*)value == 6);
+    TEST(micolisp_decrease(value, &origin) == 0);
+    TEST(micolisp_eval_string0("request", &origin, &value) != 0);
+  }
+  TEST(micolisp_close(&origin) == 0);
+}
+
+// a copy of the segment file, cut to the length and with one word of it replaced.
+
+static FILE *test_segment_copy (FILE *file, size_t length, size_t offset, uint64_t word){
+  TEST(fseek(file, 0, SEEK_END) == 0);
+  size_t size = ftell(file);
+  uint64_t *words = calloc(size / sizeof(uint64_t) + 1, sizeof(uint64_t));
+  TEST(words != NULL);
+  TEST(fseek(file, 0, SEEK_SET) == 0);
+  TEST(fread(words, 1, size, file) == size);
+  if (offset < size){ words[offset / sizeof(uint64_t)] = word; }
+  FILE *copied = tmpfile();
+  TEST(copied != NULL);
+  length = length < size ? length : size;
+  TEST(fwrite(words, 1, length, copied) == length);
+  TEST(fflush(copied) == 0);
+  free(words);
+  return copied;
+}
+
+static uint64_t test_segment_word (FILE *file, size_t offset){
+  uint64_t word;
+  TEST(fseek(file, offset, SEEK_SET) == 0);
+  TEST(fread(&word, 1, sizeof(word), file) == sizeof(word));
+  return word;
+}
+
+static void test_micolisp_segment (){
+  FILE *file = tmpfile();
+  TEST(file != NULL);
+  void *value;
+  {
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    TEST(micolisp_eval_string0("'(1 2 foo (3 4) foo)", &machine, &value) == 0);
+    TEST(micolisp_save_segment(file, value, &machine) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(list car)", &machine, &value) == 0);
+    TEST(micolisp_save_segment(file, value, &machine) != 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  TEST(fflush(file) == 0);
+  // the segment is bound to the name, and its names are interned in the machine.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    TEST(micolisp_attach_segment(file, "table", &machine) == 0);
+    TEST(micolisp_eval_string0("table", &machine, &value) == 0);
+    TEST(micolisp_segmentp(value, &machine));
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(reduce + (nth 3 table))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 7);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_eval_string0("(== (nth 2 table) 'foo)", &machine, &value) == 0);
+    TEST(value == MICOLISP_T);
+    TEST(micolisp_eval_string0("(== (nth 2 table) (nth 4 table))", &machine, &value) == 0);
+    TEST(value == MICOLISP_T);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  // names already taken in the machine keep their identity, and the segment is relocated.
+  {
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    micolisp_symbol *foo = micolisp_allocate_symbol0("foo", &machine);
+    TEST(foo != NULL);
+    TEST(micolisp_attach_segment(file, "table", &machine) == 0);
+    TEST(!machine.segments->shared);
+    TEST(micolisp_eval_string0("(nth 2 table)", &machine, &value) == 0);
+    void *valuedereferenced;
+    TEST(micolisp_reference_get(value, &machine, &valuedereferenced) == 0);
+    TEST(valuedereferenced == foo);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_decrease(foo, &machine) == 0);
+    TEST(micolisp_eval_string0("(reduce + (nth 3 table))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 7);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  // broken files are refused before they are followed, and the machine is left as it was.
+  {
+    // the words of the header after its magic and version.
+    size_t base = 24, size = 32, conses = 72, conseslength = 80, root = 96;
+    uint64_t basevalue = test_segment_word(file, base);
+    uint64_t sizevalue = test_segment_word(file, size);
+    uint64_t consesvalue = test_segment_word(file, conses);
+    FILE *broken[] = {
+      test_segment_copy(file, sizevalue / 2, sizevalue, 0),
+      test_segment_copy(file, sizevalue, conseslength, (uint64_t)1 << 60),
+      test_segment_copy(file, sizevalue, consesvalue, basevalue + sizevalue + 64),
+      test_segment_copy(file, sizevalue, consesvalue + sizeof(void*), basevalue + consesvalue + 1),
+      test_segment_copy(file, sizevalue, root, basevalue - 4096),
+    };
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    size_t symbollength = machine.symbollength;
+    for (size_t index = 0; index < sizeof(broken) / sizeof(broken[0]); index++){
+      TEST(micolisp_attach_segment(broken[index], "table", &machine) != 0);
+      TEST(machine.segments == NULL);
+      TEST(machine.symbollength == symbollength);
+      fclose(broken[index]);
+    }
+    TEST(micolisp_eval_string0("table", &machine, &value) != 0);
+    TEST(micolisp_eval_string0("(reduce + '(3 4))", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 7);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+  }
+  fclose(file);
+  // a name written twice is found while registering, so the segment is taken out again.
+  {
+    file = tmpfile();
+    TEST(file != NULL);
+    micolisp_machine machine;
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    TEST(micolisp_eval_string0("'(foo bar)", &machine, &value) == 0);
+    TEST(micolisp_save_segment(file, value, &machine) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+    TEST(fflush(file) == 0);
+    // the symbol bar is overwritten by the symbol foo word by word.
+    size_t symbols = test_segment_word(file, 56);
+    uint64_t foo[sizeof(micolisp_symbol) / sizeof(uint64_t)];
+    for (size_t index = 0; index < sizeof(foo) / sizeof(foo[0]); index++){
+      foo[index] = test_segment_word(file, symbols + index * sizeof(uint64_t));
+    }
+    FILE *twice = file;
+    for (size_t index = 0; index < sizeof(foo) / sizeof(foo[0]); index++){
+      uint64_t word = foo[index];
+      FILE *copied = test_segment_copy(twice, (size_t)-1, symbols + sizeof(micolisp_symbol) + index * sizeof(uint64_t), word);
+      fclose(twice);
+      twice = copied;
+    }
+    TEST(micolisp_open(&machine) == 0);
+    TEST(micolisp_load_library(&machine) == 0);
+    size_t symbollength = machine.symbollength;
+    TEST(micolisp_attach_segment(twice, "table", &machine) != 0);
+    TEST(machine.segments == NULL);
+    TEST(machine.symbollength == symbollength);
+    TEST(micolisp_eval_string0("'(foo bar)", &machine, &value) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_close(&machine) == 0);
+    fclose(twice);
+  }
+}
+
+static void test_micolisp_read_buffer (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  // forms are read one by one from the sequence.
+  {
+    char sequence[] = "(1 2.5 foo) ; comment\n \"ab\" bar";
+    size_t index = 0;
+    void *value;
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_typep(MICOLISP_CONS, value, &machine));
+    TEST(*(micolisp_number*)(((micolisp_cons*)((micolisp_cons*)value)->cdr)->car) == 2.5);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(index == 11);
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_typep(MICOLISP_CONS, value, &machine));
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    micolisp_symbol *bar = micolisp_allocate_symbol0("bar", &machine);
+    TEST(value == bar);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_decrease(bar, &machine) == 0);
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_EOF);
+  }
+  // a regular file is read as the list of its forms.
+  {
+    FILE *file = fopen("test/cons.lisp", "r");
+    TEST(file != NULL);
+    size_t length = 0;
+    void *value;
+    while (micolisp_read(file, &machine, &value) == MICOLISP_READ_SUCCESS){
+      TEST(micolisp_decrease(value, &machine) == 0);
+      length += 1;
+    }
+    TEST(fseek(file, 0, SEEK_SET) == 0);
+    void *forms;
+    TEST(micolisp_read_file(file, &machine, &forms) == 0);
+    for (micolisp_cons *cons = forms; cons != NULL; cons = cons->cdr){ length -= 1; }
+    TEST(length == 0);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    TEST(fclose(file) == 0);
+  }
+  // a pipe is read through the refilled buffer, and tokens across refills are kept whole.
+  {
+    FILE *file = popen("i=0; while [ $i -lt 20000 ]; do echo \"(123456 foo) ; $i\"; i=$((i+1)); done", "r");
+    TEST(file != NULL);
+    void *forms;
+    TEST(micolisp_read_file(file, &machine, &forms) == 0);
+    micolisp_symbol *foo = micolisp_allocate_symbol0("foo", &machine);
+    size_t length = 0;
+    bool wholep = true;
+    for (micolisp_cons *cons = forms; cons != NULL; cons = cons->cdr){
+      micolisp_cons *form = cons->car;
+      wholep = wholep && *(micolisp_number*)(form->car) == 123456 && ((micolisp_cons*)form->cdr)->car == foo;
+      length += 1;
+    }
+    TEST(length == 20000);
+    TEST(wholep);
+    TEST(micolisp_decrease(foo, &machine) == 0);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    TEST(pclose(file) == 0);
+  }
+  // unbalanced parens are errors.
+  {
+    char sequence[] = "(1 2) 3)";
+    size_t index = 0;
+    void *value;
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_CLOSE_PAREN);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_eval_string_all (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  void *value;
+  // eval_string evaluates only the first form.
+  TEST(micolisp_eval_string0("1 2", &machine, &value) == 0);
+  TEST(*(micolisp_number*)value == 1);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_eval_string0("", &machine, &value) != 0);
+  // eval_string_all evaluates all forms, and returns the value of the last.
+  TEST(micolisp_eval_string_all0("(var x 10) ; set x\n (var y (+ x 5)) (* x y)", &machine, &value) == 0);
+  TEST(*(micolisp_number*)value == 150);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_eval_string_all0("  ; nothing\n", &machine, &value) == 0);
+  TEST(value == MICOLISP_NIL);
+  TEST(micolisp_eval_string_all0("(+ 1 2) 3)", &machine, &value) != 0);
+  TEST(micolisp_eval_string_all0("(+ 1 2) (undefined-function)", &machine, &value) != 0);
+  // hosts evaluate many small strings, and no file is made for them.
+  for (size_t index = 0; index < 100; index++){
+    TEST(micolisp_eval_string0("(+ x 1)", &machine, &value) == 0);
+    TEST(*(micolisp_number*)value == 11);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+// the corpus is made of symbols, comments and indented whitespace, 
+// so the reader is measured rather than the allocation of numbers.
+
+static char *make_read_corpus (size_t lines, size_t *sizep){
+  char line[] = "    (define-entry alpha-beta-gamma  (delta epsilon) ; a comment which is skipped to the newline\n"
+                "        (zeta-eta-theta iota kappa))\n";
+  size_t size = (sizeof(line) -1) * lines;
+  char *corpus = malloc(size);
+  TEST(corpus != NULL);
+  for (size_t index = 0; index < size; index++){
+    corpus[index] = line[index % (sizeof(line) -1)];
+  }
+  *sizep = size;
+  return corpus;
+}
+
+static double measure_read (char *corpus, size_t size, bool bufferp, size_t *formsp){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  FILE *file = tmpfile();
+  TEST(file != NULL);
+  TEST(fwrite(corpus, 1, size, file) == size);
+  TEST(fseek(file, 0, SEEK_SET) == 0);
+  size_t forms = 0;
+  size_t index = 0;
+  clock_t start = clock();
+  while (true){
+    void *value;
+    int status = bufferp? 
+      micolisp_read_buffer(corpus, size, &index, &machine, &value):
+      micolisp_read(file, &machine, &value);
+    if (status != MICOLISP_READ_SUCCESS){ break; }
+    micolisp_decrease(value, &machine);
+    forms += 1;
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  TEST(fclose(file) == 0);
+  TEST(micolisp_close(&machine) == 0);
+  *formsp = forms;
+  return seconds;
+}
+
+static void test_micolisp_parse_number (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  char sequence[] = 
+    "1e6 -2.5E-3 .5 0x1F -0x10 0b101 0.1 3.141592653589793 "
+    "1.7976931348623157e308 4.9e-324 123456789012345678901234567890 (a .5) "
+    "1e 0x 1.2.3 + 0b2";
+  micolisp_number numbers[] = { 
+    1e6, -2.5e-3, 0.5, 31, -16, 5, 0.1, 3.141592653589793, 
+    1.7976931348623157e308, 4.9e-324, 123456789012345678901234567890.0 };
+  size_t index = 0;
+  void *value;
+  // numbers are bit-identical to the literals of the compiler.
+  for (size_t count = 0; count < sizeof(numbers) / sizeof(numbers[0]); count++){
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_typep(MICOLISP_NUMBER, value, &machine));
+    TEST(*(micolisp_number*)value == numbers[count]);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // a dot before a digit is a number, not a dotted pair.
+  TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+  TEST(micolisp_typep(MICOLISP_CONS, ((micolisp_cons*)value)->cdr, &machine));
+  TEST(*(micolisp_number*)(((micolisp_cons*)((micolisp_cons*)value)->cdr)->car) == 0.5);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  // malformed numbers are symbols.
+  for (size_t count = 0; count < 5; count++){
+    TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+    TEST(micolisp_typep(MICOLISP_SYMBOL, value, &machine));
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  TEST(micolisp_read_buffer(sequence, sizeof(sequence) -1, &index, &machine, &value) == MICOLISP_READ_EOF);
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_format_number (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  // numbers are formatted by the shortest digits, and read back to the same numbers.
+  {
+    micolisp_number numbers[] = { 0.1, 1, -42.5, 1e21, 1e-7, 0.000001, 5e-324, 1.7976931348623157e308, 1.0 / 3.0, 123456789012345678.0 };
+    char *formatted[] = { "0.1", "1", "-42.5", "1e21", "1e-7", "0.000001", "5e-324", "1.7976931348623157e308", "0.3333333333333333", "123456789012345680" };
+    for (size_t count = 0; count < sizeof(numbers) / sizeof(numbers[0]); count++){
+      char buffer[MICOLISP_NUMBER_FORMAT_LENGTH];
+      size_t length = micolisp_format_number(numbers[count], 0, buffer);
+      bool equalp = formatted[count][length] == '\0';
+      for (size_t index = 0; equalp && index < length; index++){ equalp = buffer[index] == formatted[count][index]; }
+      TEST(equalp);
+      size_t index = 0;
+      void *value;
+      TEST(micolisp_read_buffer(buffer, length, &index, &machine, &value) == MICOLISP_READ_SUCCESS);
+      TEST(*(micolisp_number*)value == numbers[count]);
+      TEST(micolisp_decrease(value, &machine) == 0);
+    }
+  }
+  // printprecision fixes the digits after the point.
+  {
+    machine.printprecision = 3;
+    FILE *file = tmpfile();
+    TEST(file != NULL);
+    void *value;
+    TEST(micolisp_eval_string0("3.14159", &machine, &value) == 0);
+    TEST(micolisp_print(value, file, &machine) == 0);
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(fseek(file, 0, SEEK_SET) == 0);
+    char buffer[16] = { 0 };
+    TEST(fread(buffer, 1, sizeof(buffer) -1, file) == 5);
+    TEST(buffer[0] == '3' && buffer[1] == '.' && buffer[2] == '1' && buffer[3] == '4' && buffer[4] == '2');
+    TEST(fclose(file) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_port (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  void *value;
+  // values are printed to a buffer.
+  {
+    TEST(micolisp_eval_string0("'(1 2.5 foo (3 . 4) nil t)", &machine, &value) == 0);
+    char *sequence;
+    size_t length;
+    TEST(micolisp_print_to_buffer(value, &machine, &sequence, &length) == 0);
+    char expected[] = "(1 2.5 foo (3 . 4) nil t)";
+    bool equalp = length == sizeof(expected) -1;
+    for (size_t index = 0; equalp && index < length; index++){ equalp = sequence[index] == expected[index]; }
+    TEST(equalp);
+    free(sequence);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // print-to-string returns the printed characters as a string.
+  {
+    TEST(micolisp_eval_string0("(print-to-string '(1 (2 3)))", &machine, &value) == 0);
+    char expected[] = "(1 (2 3))";
+    size_t index = 0;
+    bool equalp = true;
+    for (micolisp_cons *cons = value; cons != NULL; cons = cons->cdr, index++){
+      equalp = equalp && index < sizeof(expected) -1 && *(micolisp_number*)(cons->car) == expected[index];
+    }
+    TEST(equalp && index == sizeof(expected) -1);
+    TEST(micolisp_decrease(value, &machine) == 0);
+  }
+  // a port over a file writes its buffer when it is full, and the rest when it is closed.
+  {
+    FILE *file = tmpfile();
+    TEST(file != NULL);
+    micolisp_port port;
+    TEST(micolisp_port_open_file(file, &port) == 0);
+    TEST(micolisp_eval_string0("'(alpha-beta-gamma delta-epsilon-zeta)", &machine, &value) == 0);
+    size_t count = 4000;
+    for (size_t index = 0; index < count; index++){
+      if (micolisp_print_port(value, &port, &machine) != 0){ break; }
+    }
+    TEST(micolisp_decrease(value, &machine) == 0);
+    TEST(micolisp_port_close(&port) == 0);
+    TEST(ftell(file) == (long)(count * 37));
+    TEST(fclose(file) == 0);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void test_micolisp_binary (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_load_library(&machine) == 0);
+  void *shared;
+  void *rest;
+  TEST(micolisp_eval_string0("'(3 4)", &machine, &shared) == 0);
+  TEST(micolisp_eval_string0("'(1.5 -7 foo nil t 1e300 -0.0 0.1 . bar)", &machine, &rest) == 0);
+  micolisp_cons *first = micolisp_allocate_cons(shared, rest, &machine);
+  micolisp_cons *value = micolisp_allocate_cons(shared, first, &machine);
+  TEST(first != NULL && value != NULL);
+  TEST(micolisp_decrease(first, &machine) == 0);
+  TEST(micolisp_decrease(rest, &machine) == 0);
+  // a car which refers into the tail of its own list is not circular.
+  micolisp_cons *inner = micolisp_allocate_cons(shared, shared, &machine);
+  TEST(inner != NULL);
+  TEST(micolisp_decrease(shared, &machine) == 0);
+  // two binaries are read one after another from the same file.
+  FILE *file = tmpfile();
+  TEST(file != NULL);
+  TEST(micolisp_write_binary(value, file, &machine) == 0);
+  TEST(micolisp_write_binary(inner, file, &machine) == 0);
+  rewind(file);
+  void *read;
+  void *readinner;
+  TEST(micolisp_read_binary(file, &machine, &read) == 0);
+  TEST(micolisp_read_binary(file, &machine, &readinner) == 0);
+  TEST(getc(file) == EOF);
+  char *expected;
+  size_t expectedlength;
+  char *actual;
+  size_t actuallength;
+  TEST(micolisp_print_to_buffer(value, &machine, &expected, &expectedlength) == 0);
+  TEST(micolisp_print_to_buffer(read, &machine, &actual, &actuallength) == 0);
+  bool equalp = expectedlength == actuallength;
+  for (size_t index = 0; equalp && index < actuallength; index++){ equalp = expected[index] == actual[index]; }
+  TEST(equalp);
+  free(expected);
+  free(actual);
+  // shared conses stay shared.
+  micolisp_cons *readcons = read;
+  TEST(readcons->car == ((micolisp_cons*)(readcons->cdr))->car);
+  TEST(micolisp_typep(MICOLISP_CONS, readcons->car, &machine));
+  TEST(((micolisp_cons*)readinner)->car == ((micolisp_cons*)readinner)->cdr);
+  TEST(micolisp_decrease(read, &machine) == 0);
+  TEST(micolisp_decrease(readinner, &machine) == 0);
+  // circular objects and broken files are errors.
+  {
+    micolisp_cons *last = first;
+    while (micolisp_typep(MICOLISP_CONS, last->cdr, &machine)){ last = last->cdr; }
+    void *cdr = last->cdr;
+    last->cdr = value;
+    TEST(micolisp_write_binary(value, file, &machine) != 0);
+    last->cdr = cdr;
+    rewind(file);
+    TEST(fputc('x', file) != EOF);
+    rewind(file);
+    TEST(micolisp_read_binary(file, &machine, &read) != 0);
+  }
+  TEST(fclose(file) == 0);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_decrease(inner, &machine) == 0);
+  // malformed binaries are rejected without reading out of bounds.
+  {
+    // each input follows the magic and the version 1.
+    char *inputs[] = {
+      "\x80", // truncated varint of the symbol table.
+      "\x01\x05" "ab", // truncated symbol name.
+      "\x00\x00\x00\x05\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01\x07", // huge list length.
+      "\x00\x00\x05\x02\x07", // list longer than the values.
+      "\x01\x01" "a\x04\x01\x07", // bad symbol index.
+      "\x00\x06\x00\x07", // bad shared index.
+      "\x00\x02\x80\x80\x80\x80\x80\x80\x80\x80\x80\x80\x01\x07", // overlong varint.
+      "\x00\x00", // missing end.
+      "\x00\x00\x00\x07", // two values at the end.
+      "\x00\x09\x07", // unknown tag.
+    };
+    size_t lengths[] = { 1, 4, 15, 5, 6, 4, 14, 2, 4, 3 };
+    for (size_t index = 0; index < sizeof(inputs) / sizeof(inputs[0]); index++){
+      FILE *broken = tmpfile();
+      TEST(broken != NULL);
+      TEST(fwrite("micolisp-fasl\n\x01", 1, 15, broken) == 15);
+      TEST(fwrite(inputs[index], 1, lengths[index], broken) == lengths[index]);
+      rewind(broken);
+      TEST(micolisp_read_binary(broken, &machine, &read) != 0);
+      TEST(fclose(broken) == 0);
+    }
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void benchmark_micolisp_read (){
+  size_t size;
+  char *corpus = make_read_corpus(2000, &size);
+  size_t forms1;
+  size_t forms2;
+  double seconds1 = measure_read(corpus, size, false, &forms1);
+  double seconds2 = measure_read(corpus, size, true, &forms2);
+  // build with MICOLISP_CLASSIFY set to each classification to compare them.
+  char *classification = 
+    MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_LOOP? "the loop over characters": 
+    MICOLISP_CLASSIFY == MICOLISP_CLASSIFY_TABLE? "the table": 
+    "the table and SSE2";
+  printf("read of %zu bytes classified by %s: %.3fs by characters from a file, %.3fs by scanning the buffer.\n", size, classification, seconds1, seconds2);
+  TEST(forms1 == 2000);
+  TEST(forms1 == forms2);
+  free(corpus);
+}
+
+static void benchmark_micolisp_binary (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  size_t size;
+  char *corpus = make_read_corpus(500, &size);
+  FILE *text = tmpfile();
+  FILE *binary = tmpfile();
+  TEST(text != NULL && binary != NULL);
+  TEST(fwrite(corpus, 1, size, text) == size);
+  rewind(text);
+  void *value;
+  clock_t start = clock();
+  TEST(micolisp_read_file(text, &machine, &value) == 0);
+  double seconds1 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  TEST(micolisp_write_binary(value, binary, &machine) == 0);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_close(&machine) == 0);
+  long binarysize = ftell(binary);
+  rewind(binary);
+  // the binary is loaded by a fresh machine as same as the text.
+  TEST(micolisp_open(&machine) == 0);
+  start = clock();
+  TEST(micolisp_read_binary(binary, &machine, &value) == 0);
+  double seconds2 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("load of %zu bytes: %.3fs from text, %.3fs from %ld bytes of binary.\n", size, seconds1, seconds2, binarysize);
+  TEST(binarysize < (long)size);
+  TEST(micolisp_decrease(value, &machine) == 0);
+  TEST(micolisp_close(&machine) == 0);
+  TEST(fclose(text) == 0);
+  TEST(fclose(binary) == 0);
+  free(corpus);
+}
+
+static void write_script (char *path, char *text, time_t mtime){
+  FILE *file = fopen(path, "w");
+  TEST(file != NULL);
+  TEST(fputs(text, file) != EOF);
+  TEST(fclose(file) == 0);
+  if (mtime != 0){
+    struct utimbuf times = { mtime, mtime };
+    TEST(utime(path, &times) == 0);
+  }
+}
+
+static bool script_printedp (char *path, char *expected, micolisp_machine *machine){
+  void *forms;
+  if (micolisp_read_script(path, machine, &forms) != 0){ return false; }
+  char *sequence;
+  size_t length;
+  if (micolisp_print_to_buffer(forms, machine, &sequence, &length) != 0){ return false; }
+  bool equalp = true;
+  size_t index = 0;
+  for (; equalp && index < length; index++){ equalp = expected[index] == sequence[index]; }
+  equalp = equalp && expected[index] == '\0';
+  free(sequence);
+  return micolisp_decrease(forms, machine) == 0 && equalp;
+}
+
+static void test_micolisp_script_cache (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  char directory[] = "/tmp/micolisp-script-XXXXXX";
+  TEST(mkdtemp(directory) != NULL);
+  char path[64];
+  char cachepath[64];
+  char cachedirectory[64];
+  snprintf(path, sizeof(path), "%s/script.lisp", directory);
+  snprintf(cachepath, sizeof(cachepath), "%s/script.lisp.fasl", directory);
+  snprintf(cachedirectory, sizeof(cachedirectory), "%s/cache", directory);
+  time_t past = time(NULL) - 1000;
+  // caches are off by default.
+  write_script(path, "(+ 1 2) '(a b) ; comment\n", past);
+  TEST(!machine.scriptcache);
+  TEST(script_printedp(path, "((+ 1 2) (quote (a b)))", &machine));
+  TEST(fopen(cachepath, "rb") == NULL);
+  machine.scriptcache = true;
+  // the first read writes the cache next to the script.
+  write_script(path, "(+ 1 2) '(a b) ; comment\n", past);
+  TEST(script_printedp(path, "((+ 1 2) (quote (a b)))", &machine));
+  FILE *cache = fopen(cachepath, "rb");
+  TEST(cache != NULL);
+  TEST(fclose(cache) == 0);
+  // an unchanged size and mtime is trusted without reading the source.
+  write_script(path, "(- 1 2) '(c d) ; comment\n", past);
+  TEST(script_printedp(path, "((+ 1 2) (quote (a b)))", &machine));
+  // a changed mtime is checked by the hash, and a changed source is read again.
+  write_script(path, "(- 1 2) '(c d) ; comment\n", past + 1);
+  TEST(script_printedp(path, "((- 1 2) (quote (c d)))", &machine));
+  // a cache which others may write is not trusted.
+  TEST(chmod(cachepath, 0666) == 0);
+  write_script(path, "(% 1 2) '(c d) ; comment\n", past + 1);
+  TEST(script_printedp(path, "((% 1 2) (quote (c d)))", &machine));
+  TEST(chmod(cachepath, 0600) == 0);
+  // a source just written is always hashed.
+  write_script(path, "(* 1 2) '(e f) ; comment\n", 0);
+  TEST(script_printedp(path, "((* 1 2) (quote (e f)))", &machine));
+  write_script(path, "(/ 1 2) '(g h) ; comment\n", 0);
+  TEST(script_printedp(path, "((/ 1 2) (quote (g h)))", &machine));
+  TEST(remove(cachepath) == 0);
+  // caches may be kept in a directory, and be turned off.
+  machine.cachedirectory = cachedirectory;
+  machine.scriptcache = false;
+  TEST(script_printedp(path, "((/ 1 2) (quote (g h)))", &machine));
+  TEST(remove(cachedirectory) != 0);
+  machine.scriptcache = true;
+  TEST(script_printedp(path, "((/ 1 2) (quote (g h)))", &machine));
+  DIR *entries = opendir(cachedirectory);
+  TEST(entries != NULL);
+  size_t count = 0;
+  for (struct dirent *entry = readdir(entries); entry != NULL; entry = readdir(entries)){
+    if (entry->d_name[0] == '.'){ continue; }
+    char entrypath[512];
+    snprintf(entrypath, sizeof(entrypath), "%s/%s", cachedirectory, entry->d_name);
+    TEST(remove(entrypath) == 0);
+    count += 1;
+  }
+  TEST(closedir(entries) == 0);
+  TEST(count == 1);
+  TEST(remove(cachedirectory) == 0);
+  TEST(remove(path) == 0);
+  TEST(remove(directory) == 0);
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static double measure_read_parallel (char *corpus, size_t size, size_t threads, micolisp_machine *machine, void **valuep){
+  struct timespec start;
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  TEST(micolisp_read_buffer_parallel(corpus, size, threads, machine, valuep) == 0);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void test_micolisp_read_parallel (){
+  micolisp_machine machine;
+  micolisp_machine sequentialmachine;
+  TEST(micolisp_open(&machine) == 0);
+  TEST(micolisp_open(&sequentialmachine) == 0);
+  // parens and quotes in strings and comments must not split forms.
+  char line[] = 
+    "(entry \"a ( \\\" ;\" 1.5 'sym (nested (deeper . tail))) ; comment ) (\n"
+    "' quoted 42 \"str\" (a\n b)\n";
+  size_t lines = 400;
+  size_t size = (sizeof(line) -1) * lines;
+  char *corpus = malloc(size);
+  TEST(corpus != NULL);
+  for (size_t index = 0; index < size; index++){ corpus[index] = line[index % (sizeof(line) -1)]; }
+  void *sequential;
+  void *parallel;
+  // each read has its own machine, so neither is slowed by the objects of the other.
+  double seconds1 = measure_read_parallel(corpus, size, 1, &sequentialmachine, &sequential);
+  double seconds2 = measure_read_parallel(corpus, size, 4, &machine, &parallel);
+  printf("parallel read of %zu bytes: %.3fs by 1 thread, %.3fs by 4 threads.\n", size, seconds1, seconds2);
+  char *expected;
+  size_t expectedlength;
+  char *actual;
+  size_t actuallength;
+  TEST(micolisp_print_to_buffer(sequential, &sequentialmachine, &expected, &expectedlength) == 0);
+  TEST(micolisp_print_to_buffer(parallel, &machine, &actual, &actuallength) == 0);
+  bool equalp = expectedlength == actuallength;
+  for (size_t index = 0; equalp && index < actuallength; index++){ equalp = expected[index] == actual[index]; }
+  TEST(equalp);
+  free(actual);
+  // forms of every thread share the symbols of the machine.
+  size_t count = 0;
+  micolisp_symbol *entry = micolisp_allocate_symbol0("entry", &machine);
+  TEST(entry != NULL);
+  bool internedp = true;
+  for (micolisp_cons *cons = parallel; cons != NULL; cons = cons->cdr, count++){
+    if (micolisp_typep(MICOLISP_CONS, cons->car, &machine) && ((micolisp_cons*)(cons->car))->car != MICOLISP_NIL){
+      void *head = ((micolisp_cons*)(cons->car))->car;
+      if (micolisp_typep(MICOLISP_SYMBOL, head, &machine) && ((micolisp_symbol*)head)->characters[0] == 'e'){
+        internedp = internedp && head == entry;
+      }
+    }
+  }
+  TEST(internedp);
+  TEST(count == lines * 5);
+  TEST(micolisp_decrease(entry, &machine) == 0);
+  TEST(micolisp_decrease(sequential, &sequentialmachine) == 0);
+  TEST(micolisp_close(&sequentialmachine) == 0);
+  TEST(micolisp_decrease(parallel, &machine) == 0);
+  // forms read into the arena are spliced from the threads, so none of them is copied.
+  {
+    size_t reserved = machine.account.total.reserved;
+    size_t live = machine.account.total.live;
+    machine.arenamode = MICOLISP_ARENA_READ;
+    TEST(micolisp_arena_begin(&machine) == 0);
+    void *spliced;
+    double seconds1 = measure_read_parallel(corpus, size, 1, &machine, &spliced);
+    double seconds4 = measure_read_parallel(corpus, size, 4, &machine, &spliced);
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("parallel read into the arena of %zu bytes: %.3fs by 1 thread, %.3fs by 4 threads on %ld processors.\n", size, seconds1, seconds4, processors);
+    if (4 <= processors){ TEST(seconds4 < seconds1); }
+    char *actual;
+    size_t actuallength;
+    TEST(micolisp_print_to_buffer(spliced, &machine, &actual, &actuallength) == 0);
+    bool equalp = expectedlength == actuallength;
+    for (size_t index = 0; equalp && index < actuallength; index++){ equalp = expected[index] == actual[index]; }
+    TEST(equalp);
+    free(actual);
+    micolisp_symbol *entry = micolisp_allocate_symbol0("entry", &machine);
+    TEST(entry != NULL);
+    size_t count = 0;
+    bool arenap = true;
+    bool internedp = true;
+    for (micolisp_cons *cons = spliced; cons != NULL; cons = cons->cdr, count++){
+      arenap = arenap && micolisp_arenap(cons, &machine);
+      if (micolisp_typep(MICOLISP_CONS, cons->car, &machine)){
+        arenap = arenap && micolisp_arenap(cons->car, &machine);
+        void *head = ((micolisp_cons*)(cons->car))->car;
+        if (micolisp_typep(MICOLISP_SYMBOL, head, &machine) && ((micolisp_symbol*)head)->characters[0] == 'e'){
+          internedp = internedp && head == entry;
+        }
+      }
+    }
+    TEST(arenap);
+    TEST(internedp);
+    TEST(count == lines * 5);
+    TEST(micolisp_decrease(entry, &machine) == 0);
+    TEST(micolisp_arena_end(&machine) == 0);
+    machine.arenamode = MICOLISP_ARENA_NONE;
+    TEST(micolisp_collect(&machine) == 0);
+    TEST(machine.account.total.live == live);
+    TEST(machine.account.total.reserved <= reserved + 2 * 1024 * 1024);
+  }
+  free(expected);
+  // a syntax error in any chunk fails the whole read.
+  corpus[size - sizeof(line) / 2] = ')';
+  TEST(micolisp_read_buffer_parallel(corpus, size, 4, &machine, &parallel) != 0);
+  machine.arenamode = MICOLISP_ARENA_READ;
+  TEST(micolisp_arena_begin(&machine) == 0);
+  TEST(micolisp_read_buffer_parallel(corpus, size, 4, &machine, &parallel) != 0);
+  TEST(micolisp_arena_end(&machine) == 0);
+  machine.arenamode = MICOLISP_ARENA_NONE;
+  free(corpus);
+  TEST(micolisp_close(&machine) == 0);
+}
+
+static void print_forms (void *forms, micolisp_port *port, micolisp_machine *machine){
+  for (micolisp_cons *cons = forms; cons != NULL; cons = cons->cdr){
+    TEST(micolisp_print_port(cons->car, port, machine) == 0);
+    TEST(micolisp_port_write("\n", 1, port) == 0);
+  }
+}
+
+static void test_micolisp_reader (){
+  micolisp_machine machine;
+  TEST(micolisp_open(&machine) == 0);
+  micolisp_reader reader;
+  void *forms;
+  // forms are same as the pull reader, however the input is split.
+  {
+    char corpus[] = 
+      "(entry \"a ( \\\" ;\\n\" 1.5 'sym (nested (deeper . tail))) ; comment ) (\n"
+      "' quoted 42 .5 -0x1F \"str\" (a\n b . 'c) (. d) nil t symbol-at-the-end";
+    size_t size = sizeof(corpus) -1;
+    micolisp_port expected;
+    micolisp_port_open_buffer(&expected);
+    TEST(micolisp_read_buffer_parallel(corpus, size, 1, &machine, &forms) == 0);
+    print_forms(forms, &expected, &machine);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    size_t pieces[] = { 1, 2, 7, 64, size };
+    for (size_t piece = 0; piece < sizeof(pieces) / sizeof(pieces[0]); piece++){
+      micolisp_port actual;
+      micolisp_port_open_buffer(&actual);
+      micolisp_reader_init(&reader);
+      for (size_t index = 0; index < size; index += pieces[piece]){
+        TEST(micolisp_reader_feed(corpus + index, pieces[piece] < size - index? pieces[piece]: size - index, &reader, &machine, &forms) == 0);
+        print_forms(forms, &actual, &machine);
+        TEST(micolisp_decrease(forms, &machine) == 0);
+      }
+      TEST(micolisp_reader_finish(&reader, &machine, &forms) == 0);
+      print_forms(forms, &actual, &machine);
+      TEST(micolisp_decrease(forms, &machine) == 0);
+      micolisp_reader_close(&reader, &machine);
+      bool equalp = expected.length == actual.length;
+      for (size_t index = 0; equalp && index < actual.length; index++){ equalp = expected.sequence[index] == actual.sequence[index]; }
+      TEST(equalp);
+      TEST(micolisp_port_close(&actual) == 0);
+    }
+    TEST(micolisp_port_close(&expected) == 0);
+  }
+  // an open form is kept until its end is fed.
+  {
+    micolisp_reader_init(&reader);
+    TEST(micolisp_reader_feed("1 (a b", 6, &reader, &machine, &forms) == 0);
+    TEST(forms != NULL && ((micolisp_cons*)forms)->cdr == NULL);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    TEST(micolisp_reader_feed(" c) ab", 6, &reader, &machine, &forms) == 0);
+    TEST(forms != NULL && ((micolisp_cons*)forms)->cdr == NULL);
+    TEST(micolisp_typep(MICOLISP_CONS, ((micolisp_cons*)forms)->car, &machine));
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    TEST(micolisp_reader_feed("c", 1, &reader, &machine, &forms) == 0);
+    TEST(forms == NULL);
+    TEST(micolisp_reader_finish(&reader, &machine, &forms) == 0);
+    TEST(forms != NULL && micolisp_typep(MICOLISP_SYMBOL, ((micolisp_cons*)forms)->car, &machine));
+    TEST(((micolisp_symbol*)((micolisp_cons*)forms)->car)->length == 3);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    micolisp_reader_close(&reader, &machine);
+  }
+  // deep nesting does not recurse while reading.
+  {
+    size_t depth = 1000;
+    micolisp_reader_init(&reader);
+    for (size_t index = 0; index < depth; index++){
+      TEST(micolisp_reader_feed("(", 1, &reader, &machine, &forms) == 0);
+      TEST(forms == NULL);
+    }
+    TEST(reader.frameslength == depth);
+    for (size_t index = 0; index < depth -1; index++){
+      TEST(micolisp_reader_feed(")", 1, &reader, &machine, &forms) == 0);
+    }
+    TEST(micolisp_reader_feed(")", 1, &reader, &machine, &forms) == 0);
+    TEST(forms != NULL && reader.frameslength == 0);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    micolisp_reader_close(&reader, &machine);
+  }
+  // broken inputs are errors, and the pending values are released by closing.
+  {
+    char *inputs[] = { ")", "(a . b c)", "(a .)", "'(b) ')", "x . y" };
+    for (size_t index = 0; index < sizeof(inputs) / sizeof(inputs[0]); index++){
+      size_t length = 0;
+      while (inputs[index][length] != '\0'){ length++; }
+      micolisp_reader_init(&reader);
+      TEST(micolisp_reader_feed(inputs[index], length, &reader, &machine, &forms) != 0);
+      micolisp_reader_close(&reader, &machine);
+    }
+    micolisp_reader_init(&reader);
+    TEST(micolisp_reader_feed("(a \"b", 5, &reader, &machine, &forms) == 0);
+    TEST(micolisp_decrease(forms, &machine) == 0);
+    TEST(micolisp_reader_finish(&reader, &machine, &forms) != 0);
+    micolisp_reader_close(&reader, &machine);
+  }
+  TEST(micolisp_close(&machine) == 0);
+}
+
 int main (){
   test_micolisp_allocate();
   test_micolisp_scope_set();
@@ -898,5 +2742,29 @@ int main (){
   test_micolisp_print();
   test_micolisp_load_library();
   test_micolisp_eval();
+  test_micolisp_collect();
+  test_micolisp_arena();
+  test_micolisp_image();
+  benchmark_micolisp_image();
+  test_micolisp_account();
+  test_micolisp_pause();
+  test_micolisp_pool();
+  test_micolisp_region();
+  test_micolisp_weak_symbol();
+  test_micolisp_list_builder();
+  test_micolisp_number_reuse();
+  test_micolisp_clone();
+  test_micolisp_segment();
+  test_micolisp_read_buffer();
+  test_micolisp_eval_string_all();
+  benchmark_micolisp_read();
+  test_micolisp_parse_number();
+  test_micolisp_format_number();
+  test_micolisp_port();
+  test_micolisp_binary();
+  benchmark_micolisp_binary();
+  test_micolisp_script_cache();
+  test_micolisp_read_parallel();
+  test_micolisp_reader();
   return 0;
 }